@@ -22,6 +22,12 @@ struct param_category_t;
 
 {enums}
 
+// Languages of parameter names and descriptions, see ParamSelectLanguage()
+typedef enum {{
+{languages}
+}} param_lang_t;
+
+#define PARAM_NUM_LANGUAGES {n_languages}
 #define PARAM_CATEGORY_NAME_MAX_LEN {category_max_len}
 #define PARAM_NUM_CATEGORIES {n_categories}
 #define PARAM_NUM_PARAMS {n_params}
@@ -30,11 +36,39 @@ struct param_category_t;
 #define PARAM_DESC_MAX_LEN {param_desc_max_len}
 #define PARAM_VALUE_STRING_MAX_LEN {param_value_string_max_len}
 #define PARAM_ACCESS_LEVELS {n_access_levels}
+#define PARAM_MAX_ID {max_id}
+
+/**
+ * A copy of all parameter values, see ParamSnapshot()
+ */
+struct param_snapshot {{
+    /** number of parameter value changes before the copy was taken */
+    uint32_t generation;
+    /** the values, in parameter configuration order */
+    int32_t values[PARAM_NUM_PARAMS];
+}};
+
+/**
+ * Everything a settings page shows of one parameter, see ParamRowWalk()
+ */
+struct param_row {{
+    const struct param_t* param;
+    const char* name;
+    const char* unit;  // "" if the parameter has no unit
+    int32_t value;
+    char value_string[PARAM_VALUE_STRING_MAX_LEN];  // "" if the value is out of range
+    int32_t min;
+    int32_t max;
+    int exponent;
+    bool is_enum;
+}};
 
 {getter_declarations}
 
 {setter_declarations}
 
+{tx_setter_declarations}
+
 #endif
 """
 
@@ -62,25 +96,97 @@ setter_declaration = """/**
 int ParamSet{name}(const {type} value);
 """
 
+tx_setter_declaration = """/**
+* Stage parameter {name} in a transaction, see ParamTxSet()
+*
+* @return 0 on success, -1 on failure (e.g. out of range)
+* @param tx the transaction
+* @param value the value to set
+*/
+int ParamTxSet{name}(struct param_tx* tx, const {type} value);
+"""
+
 source = """
 #include "{parameters_header}"
 #include "parameters_private.h"
+#include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/settings/settings.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/zbus/zbus.h>
 #include <stdlib.h>
-#include <math.h>
+#include "koster-common/koster-zbus.h"
 LOG_MODULE_DECLARE(koster_common);
 
+#if defined(CONFIG_KOSTER_COMMON_PARAM_NOTIFY_WINDOW_MS)
+#define PARAM_NOTIFY_WINDOW_MS CONFIG_KOSTER_COMMON_PARAM_NOTIFY_WINDOW_MS
+#else
+#define PARAM_NOTIFY_WINDOW_MS 100
+#endif
+
 extern struct k_mutex param_mutex;
 static struct settings_handler handler_;
 
+// Serializes saving. Values are copied under param_mutex, which is released before they are written to flash,
+// so setters and readers never wait for a flash write. Taken before param_mutex.
+static struct k_mutex save_mutex_;
+
+// Parameters changed since they were last saved, by index in params_
+static ATOMIC_DEFINE(dirty_params_, PARAM_NUM_PARAMS);
+
+// Parameters changed since the last kMsgParamChanged message, by index in params_
+static ATOMIC_DEFINE(changed_params_, PARAM_NUM_PARAMS);
+static struct k_work_delayable notify_work_;
+
+// Incremented by every change of a parameter value, see struct param_snapshot
+static atomic_t generation_;
+
+static void notify_changed(const int index) {{
+    atomic_inc(&generation_);
+    // The first change starts the window, later changes are published with it
+    if (!atomic_test_and_set_bit(changed_params_, index)) {{
+        k_work_schedule(&notify_work_, K_MSEC(PARAM_NOTIFY_WINDOW_MS));
+    }}
+}}
+
+static void set_dirty(const int index) {{
+    atomic_set_bit(dirty_params_, index);
+    notify_changed(index);
+}}
+
+static void mark_dirty(const int index) {{
+    atomic_set_bit(dirty_params_, index);
+    param_write_behind_schedule();
+    notify_changed(index);
+}}
+
 {param_names}
 {param_descriptions}
 {category_names}
+{unit_names}
+
+// Names and descriptions of one language, by index in params_. Missing translations point to the English string.
+struct param_strings_t {{
+    const char* const* names;
+    const char* const* descriptions;
+}};
 
-static int32_t param_values_[PARAM_NUM_PARAMS];
+{language_tables}
+static const struct param_strings_t languages_[PARAM_NUM_LANGUAGES] = {{
+{languages}
+}};
+
+// Swapped by ParamSelectLanguage(), the tables it points to are const
+static const struct param_strings_t* language_ = &languages_[0];
+
+{enum_infos}
+// Each value in its declared type, widest first so that no padding is needed
+static struct {{
+{param_value_members}
+}} param_values_;
 
 static const struct param_t params_[PARAM_NUM_PARAMS] = {{
 {parameter_initializers}
@@ -90,8 +196,250 @@ static const struct param_category_t categories_[PARAM_NUM_CATEGORIES] = {{
 {category_initializers}
 }};
 
+#define SETTING_PREFIX_LEN (sizeof("parameters/") - 1)
+
+static const char* const setting_names_[PARAM_NUM_PARAMS] = {{
+{setting_names}
+}};
+
+// Index in params_ by parameter Id, -1 for unused Ids
+static const int16_t id_to_index_[PARAM_MAX_ID + 1] = {{
+{id_to_index}
+}};
+
+// Publishes the parameters changed since the last message in one kMsgParamChanged message
+static void notify_work_handler(struct k_work* work) {{
+    ARG_UNUSED(work);
+    struct kzbus_msg_t msg = {{
+        .msg_type = kMsgParamChanged,
+        .sender = "parameters",
+    }};
+
+    for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+        if (atomic_test_and_clear_bit(changed_params_, i)) {{
+            const int id = params_[i].id;
+            if (id < KZBUS_PARAM_MAX_IDS) {{
+                msg.param_msg.changed_ids[id / 8] |= 1u << (id % 8);
+            }} else {{
+                msg.param_msg.other_changed = true;
+            }}
+            ++msg.param_msg.n_changed;
+        }}
+    }}
+
+    if (msg.param_msg.n_changed > 0) {{
+        zbus_chan_pub(&kzbus_param_chan, &msg, K_NO_WAIT);
+    }}
+}}
+
+// Indices in params_, ordered by setting name for find_setting()
+static const uint16_t sorted_settings_[PARAM_NUM_PARAMS] = {{
+{sorted_settings}
+}};
+
+
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+#define BLOB_NAME "blob"
+#define BLOB_SETTING "parameters/" BLOB_NAME
+#define BLOB_SCHEMA_HASH {schema_hash}u
+#define BLOB_SIGNED 0x80  // in blob_field.type, the low bits hold the width in bytes
+#define BLOB_MAX_REMOVED_PARAMS 16
+
+struct blob_field {{
+    uint16_t id;
+    uint8_t type;
+}} __packed;
+
+struct blob_values {{
+{blob_value_members}
+}} __packed;
+
+// All values in one settings entry. The stored layout lets a blob of another schema be loaded.
+struct blob {{
+    uint32_t schema_hash;
+    uint16_t n_fields;
+    struct blob_field fields[PARAM_NUM_PARAMS];
+    struct blob_values values;
+}} __packed;
+
+static const struct blob_field blob_fields_[PARAM_NUM_PARAMS] = {{
+{blob_fields}
+}};
+
+// Also the load buffer, with room for a stored blob that has parameters this schema does not have
+static union {{
+    struct blob blob;
+    uint8_t raw[sizeof(struct blob) + BLOB_MAX_REMOVED_PARAMS * (sizeof(struct blob_field) + sizeof(int32_t))];
+}} blob_;
+static bool blob_loaded_;    // a blob was loaded, its values win over single parameter entries
+static bool legacy_loaded_;  // single parameter entries were found, delete them once the blob is saved
+#else
+// The values being saved, copied under param_mutex. Guarded by save_mutex_.
+static int32_t save_values_[PARAM_NUM_PARAMS];
+// Parameters in save_values_ that ParamFlush() has yet to write. Guarded by save_mutex_.
+static ATOMIC_DEFINE(saving_params_, PARAM_NUM_PARAMS);
+#endif
+
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+
+// Must be called with param_mutex held
+static void blob_pack() {{
+    blob_.blob.schema_hash = BLOB_SCHEMA_HASH;
+    blob_.blob.n_fields = PARAM_NUM_PARAMS;
+    memcpy(blob_.blob.fields, blob_fields_, sizeof(blob_fields_));
+{blob_pack}
+}}
+
+static void blob_unpack() {{
+{blob_unpack}
+}}
+
+/**
+ * Load the values of a blob stored with another schema, by the stored layout. Values of parameters that no
+ * longer exist or are out of range are skipped.
+ */
+static int blob_migrate(const size_t len) {{
+    const size_t header_len = offsetof(struct blob, fields);
+    if (len < header_len) {{
+        return -EINVAL;
+    }}
+
+    const uint16_t n_fields = blob_.blob.n_fields;
+    size_t offset = header_len + n_fields * sizeof(struct blob_field);
+    for (uint16_t i = 0; i < n_fields; ++i) {{
+        const struct blob_field* field = (const struct blob_field*)&blob_.raw[header_len + i * sizeof(struct blob_field)];
+        const size_t width = field->type & ~BLOB_SIGNED;
+        if (width == 0 || width > sizeof(int32_t) || offset + width > len) {{
+            return -EINVAL;
+        }}
+
+        uint32_t raw = 0;
+        for (size_t b = 0; b < width; ++b) {{
+            raw |= (uint32_t)blob_.raw[offset + b] << (8 * b);  // little endian, as stored by the MCU
+        }}
+        int32_t value = (int32_t)raw;
+        if ((field->type & BLOB_SIGNED) && width < sizeof(int32_t) && (raw & (1u << (8 * width - 1)))) {{
+            value = (int32_t)(raw | (0xFFFFFFFFu << (8 * width)));
+        }}
+        offset += width;
+
+        const struct param_t* param = ParamFindById(field->id);
+        if (param != NULL && value >= param->min && value <= param->max) {{
+            param_value_store(param, value);
+        }}
+    }}
+
+    return 0;
+}}
+
+static int blob_set(const size_t len, settings_read_cb read_cb, void* cb_arg) {{
+    if (len > sizeof(blob_.raw)) {{
+        LOG_ERR("[parameters] handle_set: stored blob too large (%zu bytes)", len);
+        return -EINVAL;
+    }}
+
+    // blob_ is also the save buffer
+    if (k_mutex_lock(&save_mutex_, K_FOREVER) != 0) {{
+        return -EBUSY;
+    }}
+    int rc = -EBUSY;
+    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
+        rc = read_cb(cb_arg, blob_.raw, len);
+        if (rc >= 0) {{
+            const bool migrate = len != sizeof(struct blob) || blob_.blob.schema_hash != BLOB_SCHEMA_HASH;
+            param_update_begin();
+            if (!migrate) {{
+                blob_unpack();
+                rc = 0;
+            }} else {{
+                LOG_WRN("[parameters] Stored blob has another schema (0x%08X), migrating", blob_.blob.schema_hash);
+                rc = blob_migrate(len);
+            }}
+            param_update_end();
+            for (int i = 0; rc == 0 && i < PARAM_NUM_PARAMS; ++i) {{
+                if (migrate) {{
+                    mark_dirty(i);  // store it again in this schema
+                }} else {{
+                    notify_changed(i);
+                }}
+            }}
+            blob_loaded_ = rc == 0;
+        }}
+        k_mutex_unlock(&param_mutex);
+    }}
+    k_mutex_unlock(&save_mutex_);
+
+    return rc;
+}}
+
+// Must be called with save_mutex_ held, after blob_pack()
+static int blob_write() {{
+    int rc = settings_save_one(BLOB_SETTING, &blob_.blob, sizeof(struct blob));
+    if (rc != 0) {{
+        LOG_ERR("[parameters] Unable to save parameters (err %d)", rc);
+        return rc;
+    }}
+
+    if (legacy_loaded_) {{
+        for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+            settings_delete(setting_names_[i]);
+        }}
+        legacy_loaded_ = false;
+    }}
+    return 0;
+}}
+#endif
+
+// Default values, in params_ order
+static const int32_t production_defaults_[PARAM_NUM_PARAMS] = {{
+{production_defaults}
+}};
+
+// Default overrides of all machine types, as params_ index and value. The entries of a machine type are
+// those from first up to, not including, last.
+static const uint16_t override_params_[] = {{
+{override_params}
+}};
+static const int32_t override_values_[] = {{
+{override_values}
+}};
+static const struct {{
+    int32_t machine_type;
+    uint16_t first;
+    uint16_t last;
+}} machine_overrides_[] = {{
+{machine_overrides}
+}};
+
+/**
+ * Binary search of a setting name (without the "parameters/" prefix)
+ *
+ * @return the index in params_, or -1 if there is no such parameter
+ */
+static int find_setting(const char* name, const size_t name_len) {{
+    int low = 0;
+    int high = PARAM_NUM_PARAMS - 1;
+
+    while (low <= high) {{
+        const int mid = (low + high) / 2;
+        const char* key = setting_names_[sorted_settings_[mid]] + SETTING_PREFIX_LEN;
+        int cmp = strncmp(key, name, name_len);
+        if (cmp == 0 && key[name_len] != '\\0') {{
+            cmp = 1;  // name is a prefix of key
+        }}
+
+        if (cmp == 0) {{
+            return sorted_settings_[mid];
+        }}
+        if (cmp < 0) {{
+            low = mid + 1;
+        }} else {{
+            high = mid - 1;
+        }}
+    }}
 
-{get_value_string_funcs}
+    return -1;
+}}
 
 static int handle_set(const char* name, size_t len, settings_read_cb read_cb, void* cb_arg) {{
     const char* next;
@@ -99,44 +447,134 @@ static int handle_set(const char* name, size_t len, settings_read_cb read_cb, vo
 
     name_len = settings_name_next(name, &next);
 
-    {handle_set_cases}
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+    if (name_len == sizeof(BLOB_NAME) - 1 && !strncmp(name, BLOB_NAME, name_len)) {{
+        return blob_set(len, read_cb, cb_arg);
+    }}
+#endif
+
+    const int index = find_setting(name, name_len);
+    if (index < 0) {{
+        return -ENOENT;
+    }}
+
+    if (len != sizeof(int32_t)) {{
+        LOG_ERR("[parameters] handle_set: read size (%o) different from size of int32_t (%s)", len,
+                setting_names_[index]);
+        return -EINVAL;
+    }}
+
+    int32_t value;
+    int rc = read_cb(cb_arg, &value, sizeof(int32_t));
+    if (rc < 0) {{
+        return rc;
+    }}
+    // Would not fit the storage type, keep the default
+    if (value < params_[index].min || value > params_[index].max) {{
+        LOG_WRN("[parameters] handle_set: value %d out of range (%s)", value, setting_names_[index]);
+        return 0;
+    }}
 
-    return -ENOENT;
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+    // Stored before the switch to blob storage, migrate it into the blob
+    legacy_loaded_ = true;
+    mark_dirty(index);
+    if (blob_loaded_) {{
+        return 0;
+    }}
+#endif
+    param_value_store(&params_[index], value);
+    notify_changed(index);
+    return 0;
 }}
 
 static int handle_export(int (*storage_func)(const char* name, const void* value, size_t val_len)) {{
+    if (k_mutex_lock(&save_mutex_, K_FOREVER) != 0) {{
+        return -EBUSY;
+    }}
     int ret = -EBUSY;
     if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
-{handle_export_cases}
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+        blob_pack();
+#else
+        for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+            save_values_[i] = param_value_load(&params_[i]);
+        }}
+#endif
         k_mutex_unlock(&param_mutex);
+        ret = 0;
     }}
+
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+    if (ret == 0) {{
+        ret = storage_func(BLOB_SETTING, &blob_.blob, sizeof(struct blob));
+    }}
+#else
+{handle_export_cases}
+#endif
+    k_mutex_unlock(&save_mutex_);
     return ret;
 }}
 
-static void load_production_defaults() {{
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
-    {param_production_default_values}
-        k_mutex_unlock(&param_mutex);
+// Must be called with param_mutex held
+static void store_production_defaults() {{
+    for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+        param_value_store(&params_[i], production_defaults_[i]);
+    }}
+}}
+
+// Must be called with param_mutex held
+static void store_machine_defaults(const int32_t machine_type) {{
+    for (size_t m = 0; m < ARRAY_SIZE(machine_overrides_); ++m) {{
+        if (machine_overrides_[m].machine_type != machine_type) {{
+            continue;
+        }}
+        for (unsigned int i = machine_overrides_[m].first; i < machine_overrides_[m].last; ++i) {{
+            param_value_store(&params_[override_params_[i]], override_values_[i]);
+        }}
+        return;
     }}
 }}
 
 void ParamLoadDefaults(const int32_t machine_type) {{
-    load_production_defaults();
+    // One lock section, so a flush never saves the production defaults without the overrides
     if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
-        param_values_[0] = machine_type;
-        switch ( machine_type ) {{
-{param_default_overrides}
-            default:
-                LOG_ERR("[parameter] Unknown machine type (%o). Loaded production defaults.", machine_type);
-        k_mutex_unlock(&param_mutex);
+        param_update_begin();
+        store_production_defaults();
+        // The machine type is the first parameter
+        if (machine_type >= params_[0].min && machine_type <= params_[0].max) {{
+            param_value_store(&params_[0], machine_type);
+            store_machine_defaults(machine_type);
+        }} else {{
+            LOG_ERR("[parameter] Unknown machine type (%d). Loaded production defaults.", machine_type);
+        }}
+        param_update_end();
+        for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+            set_dirty(i);
         }}
+        param_write_behind_schedule();
+        k_mutex_unlock(&param_mutex);
     }}
 }}
 
 int ParamInit() {{
     k_mutex_init(&param_mutex);
+    k_mutex_init(&save_mutex_);
+    param_write_behind_init();
+    k_work_init_delayable(&notify_work_, notify_work_handler);
 
-    load_production_defaults();
+    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
+        store_production_defaults();
+        k_mutex_unlock(&param_mutex);
+    }}
+    for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+        atomic_clear_bit(dirty_params_, i);
+        atomic_clear_bit(changed_params_, i);
+    }}
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+    blob_loaded_ = false;
+    legacy_loaded_ = false;
+#endif
 
     handler_.name = "parameters";
     handler_.h_get = NULL;
@@ -163,142 +601,281 @@ int ParamInit() {{
 
 {setter_definitions}
 
+{tx_setter_definitions}
+
 int ParamGetCategory(const struct param_category_t** category, const unsigned int index) {{
+    if (index >= PARAM_NUM_CATEGORIES) {{
+        return -1;
+    }}
+    *category = &categories_[index];
+    return 0;
+}}
+
+int ParamSelectLanguage(const unsigned int language) {{
+    if (language >= PARAM_NUM_LANGUAGES) {{
+        return -1;
+    }}
+    __atomic_store_n(&language_, &languages_[language], __ATOMIC_RELAXED);
+    return 0;
+}}
+
+const char* param_name(const struct param_t* param) {{
+    return __atomic_load_n(&language_, __ATOMIC_RELAXED)->names[param - params_];
+}}
+
+const char* param_description(const struct param_t* param) {{
+    return __atomic_load_n(&language_, __ATOMIC_RELAXED)->descriptions[param - params_];
+}}
+
+const struct param_t* ParamFindById(const int id) {{
+    if (id < 0 || id > PARAM_MAX_ID || id_to_index_[id] < 0) {{
+        return NULL;
+    }}
+    return &params_[id_to_index_[id]];
+}}
+
+int ParamSave(const struct param_t* param) {{
     int rc = -1;
+    if ( param == NULL ) {{
+        return rc;
+    }}
+
+    if (k_mutex_lock(&save_mutex_, K_FOREVER) != 0) {{
+        return rc;
+    }}
+    const int index = param - params_;
     if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
-        if (index < PARAM_NUM_CATEGORIES) {{
-            *category = &categories_[index];
-            rc = 0;
-        }}
+        // Cleared before the value is copied, so a change during the write marks it again
+        atomic_clear_bit(dirty_params_, index);
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+        blob_pack();
+#else
+        save_values_[index] = param_value_load(param);
+#endif
         k_mutex_unlock(&param_mutex);
+        rc = 0;
+    }}
+
+    if (rc == 0) {{
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+        rc = blob_write();
+#else
+        rc = settings_save_one(setting_names_[index], &save_values_[index], sizeof(int32_t));
+        if (rc != 0) {{
+            LOG_ERR("[parameters] Unable to save parameter %s (err %d)", setting_names_[index], rc);
+        }}
+#endif
+        if (rc != 0) {{
+            atomic_set_bit(dirty_params_, index);
+        }}
     }}
+    k_mutex_unlock(&save_mutex_);
     return rc;
 }}
 
-int ParamGetValueString(const struct param_t* param, char* buf, const int32_t value) {{
-    int rc = -1;
-    if (param == NULL) {{
-        return rc;
+void param_mark_dirty(const struct param_t* param) {{
+    mark_dirty(param - params_);
+}}
+
+void param_set_dirty(const struct param_t* param) {{
+    set_dirty(param - params_);
+}}
+
+void param_notify_changed(const struct param_t* param) {{
+    notify_changed(param - params_);
+}}
+
+int ParamSnapshot(struct param_snapshot* snapshot) {{
+    if (snapshot == NULL) {{
+        return -1;
     }}
 
+    int rc = -1;
     if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
-        if (value >= param->min && value <= param->max ) {{
-            switch (param->id) {{
-{get_value_string_cases}
-            default:
-                if ( param->exponent >= 0 ) {{
-                    snprintf(buf, PARAM_VALUE_STRING_MAX_LEN, "%i", value);
-                }} else {{
-                    char fmt_buf[PARAM_VALUE_STRING_MAX_LEN];
-                    snprintf(fmt_buf, PARAM_VALUE_STRING_MAX_LEN, "%%.%uf", abs(param->exponent));
-                    snprintf(buf, PARAM_VALUE_STRING_MAX_LEN, fmt_buf, value*pow(10.0, param->exponent));
-                }}
-                rc = 0;
-                break;
-            }}
+        // Single values are stored without the lock, so copy value by value rather than with memcpy()
+        for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+            snapshot->values[i] = param_value_load(&params_[i]);
         }}
+        snapshot->generation = atomic_get(&generation_);
         k_mutex_unlock(&param_mutex);
+        rc = 0;
     }}
     return rc;
 }}
 
-int ParamSave(const struct param_t* param) {{
+int ParamRestore(const struct param_snapshot* snapshot) {{
+    if (snapshot == NULL) {{
+        return -1;
+    }}
+
     int rc = -1;
     if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
-        if ( param == NULL ) {{
-            return -1;
+        rc = 0;
+        param_update_begin();
+        for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+            if (param_value_load(&params_[i]) != snapshot->values[i]) {{
+                param_value_store(&params_[i], snapshot->values[i]);
+                set_dirty(i);
+                ++rc;
+            }}
         }}
-        switch (param->id) {{
-{settings_save_cases}
+        param_update_end();
+        if (rc > 0) {{
+            param_write_behind_schedule();
         }}
         k_mutex_unlock(&param_mutex);
     }}
     return rc;
 }}
 
-
-"""
-get_value_string_func = """
-int get_value_string_{type}(const int32_t value, char *buf) {{
-    switch (value) {{
-        {get_value_string_type_cases}
+bool ParamHasUnsavedChanges() {{
+    for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+        if (atomic_test_bit(dirty_params_, i)) {{
+            return true;
+        }}
     }}
-    return -1;
-}}"""
-get_value_string_type_case = """
-        case {value}:
-            strncpy(buf, "{string}", PARAM_VALUE_STRING_MAX_LEN);
-            return 0;"""
-get_value_string_case = """
-            case {id}:
-                rc = get_value_string_{type}(value, buf);
-                break;"""
+    return false;
+}}
 
-getter_definition = """{type} ParamGet{name}(){{
-    return ({type})param_values_[{index}];
-}}"""
+#if defined(CONFIG_KOSTER_COMMON_PARAM_BLOB_STORAGE)
+int ParamFlush() {{
+    int n_saved = 0;
+    int rc = -EBUSY;
 
-setter_definition = """int ParamSet{name}(const {type} value) {{
-    int rc = -1;
-    if ( !(value >= {min} && value <= {max}) ){{
+    if (k_mutex_lock(&save_mutex_, K_FOREVER) != 0) {{
         return rc;
     }}
-
     if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
-        param_values_[{index}] = (int32_t)value;
+        for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+            // Cleared before the values are packed, so a change during the write marks it again
+            if (atomic_test_and_clear_bit(dirty_params_, i)) {{
+                ++n_saved;
+            }}
+        }}
+        if (n_saved > 0) {{
+            blob_pack();
+        }}
         k_mutex_unlock(&param_mutex);
         rc = 0;
     }}
-    return rc;
-}}"""
 
-parameter_initializer = "    {{{id}, kParamName_{name}, {type}, {access}, kParamDescription_{name}, &param_values_[{index}], {min}, {max}, {exponent}}},"
-param_name = 'static const char kParamName_{name}[] = "{display_name}";';
-param_description = 'static const char kParamDescription_{name}[] = "{description}";';
-category_name = 'static const char kCategoryName_{name}[] = "{display_name}";';
-
-category_initializer = "    {{{id}, kCategoryName_{name}, {{{n_params_in_category_per_access_level}}}, {{{category_parameter_ptrs}}}}},"
-category_parameter_ptr = "&params_[{parameter_ptr}]"
-
-handle_set_case = """
-    if (!strncmp(name, "{name}", name_len)) {{
-        if (len != sizeof(int32_t)) {{
-            LOG_ERR("[parameters] handle_set: read size (%o) different from size of int32_t (parameter {name})", len);
-            return -EINVAL;
+    if (n_saved > 0) {{
+        rc = blob_write();
+        // The blob was not saved, all of it is still unsaved
+        for (int i = 0; rc != 0 && i < PARAM_NUM_PARAMS; ++i) {{
+            atomic_set_bit(dirty_params_, i);
         }}
+    }}
+    k_mutex_unlock(&save_mutex_);
 
-        int rc = -EBUSY;
-        if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
-            rc = read_cb(cb_arg, &param_values_[{index}], sizeof(int32_t));
-            k_mutex_unlock(&param_mutex);
-            if (rc >= 0) {{
-                return 0;
+    return rc != 0 ? rc : n_saved;
+}}
+#else
+int ParamFlush() {{
+    int n_saved = 0;
+    int rc = -EBUSY;
+
+    if (k_mutex_lock(&save_mutex_, K_FOREVER) != 0) {{
+        return rc;
+    }}
+    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {{
+        for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+            // Cleared before the value is copied, so a change during the writes marks it again
+            if (atomic_test_and_clear_bit(dirty_params_, i)) {{
+                save_values_[i] = param_value_load(&params_[i]);
+                atomic_set_bit(saving_params_, i);
             }}
         }}
+        k_mutex_unlock(&param_mutex);
+        rc = 0;
+    }}
 
-        return rc;
-    }}"""
-handle_export_case = """
-        ret = storage_func("parameters/{name}", &param_values_[{index}], sizeof(int32_t));
-        if ( ret != 0 ) {{
-            k_mutex_unlock(&param_mutex);
-            return ret;
+    for (int i = 0; i < PARAM_NUM_PARAMS; ++i) {{
+        if (!atomic_test_and_clear_bit(saving_params_, i)) {{
+            continue;
         }}
-    """
-settings_save_case = """
-        case {id}:
-            rc = settings_save_one("parameters/{name}", &param_values_[{index}], sizeof(int32_t));
-            if ( rc != 0 ) {{
-                LOG_ERR("[parameters] Unable to save parameter {name}");
+        // After an error the rest is not written, and stays unsaved
+        if (rc == 0) {{
+            rc = settings_save_one(setting_names_[i], &save_values_[i], sizeof(int32_t));
+            if (rc == 0) {{
+                ++n_saved;
+                continue;
             }}
-            break;
+            LOG_ERR("[parameters] Unable to save parameter %s (err %d)", setting_names_[i], rc);
+        }}
+        atomic_set_bit(dirty_params_, i);
+    }}
+    k_mutex_unlock(&save_mutex_);
+
+    return rc != 0 ? rc : n_saved;
+}}
+#endif
+
+
 """
-param_default_override = """
-        case {machine_type_id}:
-{param_value_setters}
-            break;
+enum_info = """static const char* const enum_labels_{name}[] = {{
+{labels}
+}};
+static const int32_t enum_row_values_{name}[] = {{{row_values}}};
+static const int16_t enum_value_rows_{name}[] = {{{value_rows}}};
+static const struct param_enum_info_t enum_info_{name} = {{
+    enum_labels_{name},
+    ARRAY_SIZE(enum_labels_{name}),
+    "{options}",
+    enum_row_values_{name},
+    enum_value_rows_{name},
+    ARRAY_SIZE(enum_row_values_{name}),
+}};
 """
-param_value_setter = "            param_values_[{index}] = {value};"
+enum_label = '    [{value}] = "{label}",'
+
+getter_definition = """{type} ParamGet{name}(){{
+    return ({type})param_value_load(&params_[{index}]);
+}}"""
+
+setter_definition = """int ParamSet{name}(const {type} value) {{
+    if ( !(value >= {min} && value <= {max}) ){{
+        return -1;
+    }}
+
+    param_value_store(&params_[{index}], (int32_t)value);
+    mark_dirty({index});
+    return 0;
+}}"""
+
+tx_setter_definition = """int ParamTxSet{name}(struct param_tx* tx, const {type} value) {{
+    return ParamTxSet(tx, &params_[{index}], (int32_t)value);
+}}"""
+
+parameter_initializer = "    {{{id}, {type}, {access}, &param_values_.{name}, {storage}, {min}, {max}, {exponent}, {unit}, {enum_info}}},"
+param_name = 'static const char kParamName_{name}{suffix}[] = "{display_name}";'
+param_description = 'static const char kParamDescription_{name}{suffix}[] = "{description}";'
+language = "    kParamLang{lang} = {index},"
+language_table = """static const char* const param_names_{lang}[PARAM_NUM_PARAMS] = {{
+{names}
+}};
+static const char* const param_descriptions_{lang}[PARAM_NUM_PARAMS] = {{
+{descriptions}
+}};
+"""
+language_strings = "    {{param_names_{lang}, param_descriptions_{lang}}},"
+category_name = 'static const char kCategoryName_{name}[] = "{display_name}";';
+unit_name = 'static const char kUnitName_{id}[] = "{display_name}";'
+
+category_initializer = "    {{{id}, kCategoryName_{name}, {{{n_params_in_category_per_access_level}}}, {{{category_parameter_ptrs}}}}},"
+category_parameter_ptr = "&params_[{parameter_ptr}]"
+setting_name = '    "parameters/{name}",'
+
+handle_export_case = """    if (ret == 0) {{
+        ret = storage_func("parameters/{name}", &save_values_[{index}], sizeof(int32_t));
+    }}"""
+machine_override = "    {{{machine_type_id}, {first}, {last}}},"
+
+blob_value_member = "    {type} {name};"
+blob_field = "    {{{id}, {width}{signed}}},"
+blob_pack_value = "    blob_.blob.values.{name} = ({type})param_value_load(&params_[{index}]);"
+blob_unpack_value = "    param_value_store(&params_[{index}], blob_.blob.values.{name});"
+param_value_member = "    {type} {name};"
 
 
 class Configuration:
@@ -312,6 +889,8 @@ class Configuration:
         self.enums = {} # {str : {str : str}}, {"Name" : {"Name" : "Value"}}
         self.parameters = {} # {str : {str : str}}, {"Id" : {<attribute> : <value>}}
         self.overrides = {} # {str : {str : str}}, {"MachineType" : {"Parameter Id" : <value>}}
+        self.langs : list[str] = ["EN"]
+        self.translations = {} # {str : {str : {str : str}}}, {"Id" : {"Lang" : {<attribute> : <value>}}}
         
     def _elements_to_unique_key_value_dict(self, element_tree, element_name : str, key_attrib : str, value_attrib : str):
         key_value_dict = {}
@@ -364,6 +943,18 @@ class Configuration:
 
             self.parameters[id] = element.attrib
 
+            self.translations[id] = {}
+            for lang_override in element.iter("LanguageOverride"):
+                lang = lang_override.get("Lang")
+                if lang == "EN" or lang in self.translations[id]:
+                    error_txt = f'Duplicate LanguageOverride "{lang}" for Parameter with Id "{id}"'
+                    raise RuntimeError(error_txt)
+
+                if lang not in self.langs:
+                    self.langs.append(lang)
+
+                self.translations[id][lang] = lang_override.attrib
+
         for category in self.categories:
             if len([1 for p in self.parameters.values() if p["Category"] == category]) == 0:
                 error_txt = f'Category "{category}" has no parameters'
@@ -372,6 +963,10 @@ class Configuration:
         # parameter validation
         for id in self.parameters:
 
+            if not id.isdigit() or int(id) > 32767:
+                error_txt = f'Parameter Id "{id}" must be an integer from 0 to 32767'
+                raise RuntimeError(error_txt)
+
             if id == "0" and self.parameters[id]["Name"] != "Machine type":
                 error_txt = f'Parameter with Id 0 must be "Machine type"'
                 raise RuntimeError(error_txt)
@@ -463,6 +1058,41 @@ class Configuration:
 
 
 
+def fnv1a(data : bytes) -> int:
+    hash = 0x811C9DC5
+    for byte in data:
+        hash = ((hash ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return hash
+
+def storage_type(type : str, enums : dict) -> str:
+    """The narrowest C type that holds all values of a parameter type"""
+    if type not in enums:
+        return type
+    values = [int(v) for v in enums[type].values()]
+    for candidate, lowest, highest in [("uint8_t", 0, 255), ("int8_t", -128, 127), ("uint16_t", 0, 65535),
+                                       ("int16_t", -32768, 32767)]:
+        if min(values) >= lowest and max(values) <= highest:
+            return candidate
+    return "int32_t"
+
+value_type_size = {"uint8_t": 1, "int8_t": 1, "uint16_t": 2, "int16_t": 2, "int32_t": 4}
+
+def value_storage(type : str, enums : dict) -> tuple:
+    """The C type a parameter value is kept in at run time, and its param_storage_t"""
+    stored_type = storage_type(type, enums)
+    kinds = {"uint8_t": "kParamStorageU8", "int8_t": "kParamStorageI8",
+             "uint16_t": "kParamStorageU16", "int16_t": "kParamStorageI16"}
+    if stored_type in kinds:
+        return stored_type, kinds[stored_type]
+    return "int32_t", "kParamStorageI32"
+
+def format_fixed(value : int, exponent : int) -> str:
+    """value * 10^exponent as formatted by param_format_fixed()"""
+    if exponent >= 0:
+        return str(value)
+    digits = str(abs(value)).rjust(-exponent + 1, "0")
+    return ("-" if value < 0 else "") + digits[:exponent] + "." + digits[exponent:]
+
 def to_camelcase(string : str) -> str:
     return "".join([s.capitalize() for s in string.split()]).replace(".", "")
     
@@ -476,18 +1106,20 @@ class SourceGenerator:
     def generate(self, header_path: Path, source_path: Path):
         enums = []
 
-        get_value_string_funcs = []
+        enum_infos = []
         param_value_string_len = [10] # 10 chars for int32_t
+        used_enums = {p["Type"] for p in self.config.parameters.values()}
         for enum_name in self.config.enums:
             enum_values = []
-            get_value_string_type_cases = []
+            enum_labels = []
+            rows = []  # (value, label) in value order
             for member_name in self.config.enums[enum_name]:
                 value = self.config.enums[enum_name][member_name]
+                if int(value) < 0:
+                    raise ValueError(f"Enum {enum_name}: value {member_name} is negative")
                 enum_values.append(enum_value.format(name=member_name, value=value))
-                get_value_string_type_cases.append(get_value_string_type_case.format(
-                    value=value,
-                    string=member_name
-                ))
+                enum_labels.append(enum_label.format(value=value, label=member_name))
+                rows.append((int(value), member_name))
                 param_value_string_len.append(len(member_name))
 
             enums.append(enum_definition.format(
@@ -495,25 +1127,37 @@ class SourceGenerator:
                 values='\n'.join(enum_values),
                 n_values=len(enum_values)
             ))
-            get_value_string_funcs.append(get_value_string_func.format(
-                type=f"param_{enum_name}",
-                get_value_string_type_cases="\n".join(get_value_string_type_cases)
-            ))
+            # Only for enums of parameters, unused static tables would warn
+            if enum_name in used_enums:
+                rows.sort()
+                value_rows = {value: row for row, (value, _) in enumerate(rows)}
+                enum_infos.append(enum_info.format(
+                    name=enum_name,
+                    labels="\n".join(enum_labels),
+                    options="\\n".join(label for _, label in rows),
+                    row_values=", ".join(str(value) for value, _ in rows),
+                    value_rows=", ".join(str(value_rows.get(v, -1)) for v in range(rows[-1][0] + 1)),
+                ))
 
         getter_declarations = []
         setter_declarations = []
         getter_definitions = []
         setter_definitions = []
+        tx_setter_declarations = []
+        tx_setter_definitions = []
         parameter_initializers = []
         category_initializers = []
-        get_value_string_cases = []
         id_to_index = {}
-        handle_set_cases = []
         handle_export_cases = []
-        settings_save_cases = []
         param_names = []
         param_descriptions = []
-        param_default_values = []
+        production_defaults = []
+        setting_names = []
+        blob_value_members = []
+        blob_fields = []
+        blob_pack = []
+        blob_unpack = []
+        param_value_members = []
         for i,param in enumerate(self.config.parameters):
             id_to_index[param] = i
             type = self.config.parameters[param]["Type"]
@@ -531,7 +1175,6 @@ class SourceGenerator:
             if type in self.config.enums:
                 default = f"kParam{default}"
                 type_name = f"param_{type}"
-                get_value_string_cases.append(get_value_string_case.format(id=param, type=type_name))
                 
             setter_definitions.append(setter_definition.format(
                 index=i,
@@ -540,26 +1183,59 @@ class SourceGenerator:
                 min=minimum,
                 max=maximum
             ))
+            value_type, storage = value_storage(type, self.config.enums)
+            param_value_members.append((value_type, param_value_member.format(type=value_type, name=name)))
             parameter_initializers.append(parameter_initializer.format(
                 index=i,
+                storage=storage,
                 id=param,
                 name=name,
                 type="kParamTypeEnum" if type in self.config.enums else "kParamTypeNumeric",
                 access=self.config.access_levels[self.config.parameters[param]["AccessLevel"]],
                 min=minimum,
                 max=maximum,
-                exponent=self.config.parameters[param]["Exponent"] if "Exponent" in self.config.parameters[param] else 0
+                exponent=self.config.parameters[param]["Exponent"] if "Exponent" in self.config.parameters[param] else 0,
+                enum_info=f"&enum_info_{type}" if type in self.config.enums else "NULL",
+                unit=f'kUnitName_{self.config.units[self.config.parameters[param]["Unit"]]}' if "Unit" in self.config.parameters[param] else '""'
             ))
+            if type not in self.config.enums:
+                exponent = int(self.config.parameters[param]["Exponent"])
+                param_value_string_len += [len(format_fixed(int(minimum), exponent)),
+                                           len(format_fixed(int(maximum), exponent))]
             getter_declarations.append(getter_declaration.format(type=type_name, name=name))
             setter_declarations.append(setter_declaration.format(type=type_name, name=name))
+            tx_setter_declarations.append(tx_setter_declaration.format(type=type_name, name=name))
+            tx_setter_definitions.append(tx_setter_definition.format(type=type_name, name=name, index=i))
             getter_definitions.append(getter_definition.format(type=type_name, name=name, index=i))
-            handle_set_cases.append(handle_set_case.format(name=name, index=i))
             handle_export_cases.append(handle_export_case.format(name=name, index=i))
-            settings_save_cases.append(settings_save_case.format(name=name, index=i, id=param))
-            param_names.append(param_name.format(name=name, display_name=self.config.parameters[param]["Name"]))
-            param_descriptions.append(param_description.format(name=name, description=self.config.parameters[param]["Description"]))
-            param_default_values.append(param_value_setter.format(index=i, value=default))
+            setting_names.append(setting_name.format(name=name))
+            stored_type = storage_type(type, self.config.enums)
+            blob_value_members.append(blob_value_member.format(type=stored_type, name=name))
+            blob_fields.append(blob_field.format(
+                id=param,
+                width=f"sizeof({stored_type})",
+                signed="" if stored_type.startswith("u") else " | BLOB_SIGNED"
+            ))
+            blob_pack.append(blob_pack_value.format(type=stored_type, name=name, index=i))
+            blob_unpack.append(blob_unpack_value.format(name=name, index=i))
+            param_names.append(param_name.format(name=name, suffix="", display_name=self.config.parameters[param]["Name"]))
+            param_descriptions.append(param_description.format(name=name, suffix="", description=self.config.parameters[param]["Description"]))
+            for lang, translation in self.config.translations[param].items():
+                if "Name" in translation:
+                    param_names.append(param_name.format(name=name, suffix=f"_{lang}", display_name=translation["Name"]))
+                if "Description" in translation:
+                    param_descriptions.append(param_description.format(name=name, suffix=f"_{lang}", description=translation["Description"]))
+            production_defaults.append(f"    {default},")
             
+        # Byte order, as compared by strncmp() in find_setting()
+        setting_order = sorted(range(len(self.config.parameters)),
+                               key=lambda i: to_camelcase(list(self.config.parameters.values())[i]["Name"]).encode())
+        sorted_settings = ",\n".join(f"    {i}" for i in setting_order)
+
+        index_by_id = {int(param): i for param, i in id_to_index.items()}
+        max_id = max(index_by_id)
+        id_to_index_table = ",\n".join(f"    {index_by_id.get(id, -1)}" for id in range(max_id + 1))
+
         categories = []
         n_params_in_category = []
         category_initializers = []
@@ -583,51 +1259,103 @@ class SourceGenerator:
             n_params_in_category.append(n_params_per_access_level[-1]) # last element is the highest access level which has access to all parameters
             category_names.append(category_name.format(name=to_camelcase(name), display_name=name))
 
-        param_default_overrides = []
+        override_params = []
+        override_values = []
+        machine_overrides = []
         for machine_type in self.config.overrides:
-            param_value_setters = []
+            first = len(override_params)
             for param_id in self.config.overrides[machine_type]:
                 default = self.config.overrides[machine_type][param_id]
                 if self.config.parameters[param_id]["Type"] in self.config.enums:
                     default = f"kParam{default}"
-                param_value_setters.append(param_value_setter.format(index=id_to_index[param_id], value=default))
-            param_default_overrides.append(param_default_override.format(
+                override_params.append(f"    {id_to_index[param_id]},")
+                override_values.append(f"    {default},")
+            machine_overrides.append(machine_override.format(
                 machine_type_id=self.config.enums["machine_type_t"][machine_type],
-                param_value_setters="\n".join(param_value_setters))
+                first=first,
+                last=len(override_params))
             )
+        # No zero length arrays in C, the sentinel entries are not referenced by machine_overrides_
+        if not machine_overrides:
+            override_params.append("    0,")
+            override_values.append("    0,")
+            machine_overrides.append(machine_override.format(machine_type_id=-1, first=0, last=0))
         
+        languages = []
+        language_tables = []
+        language_strings_list = []
+        # Lengths in bytes, translations need not be ASCII
+        name_lens = [len(p["Name"].encode()) for p in self.config.parameters.values()]
+        desc_lens = [len(p["Description"].encode()) for p in self.config.parameters.values()]
+        for index, lang in enumerate(self.config.langs):
+            names = []
+            descriptions = []
+            for param in self.config.parameters:
+                name = to_camelcase(self.config.parameters[param]["Name"])
+                translation = self.config.translations[param].get(lang, {})
+                names.append(f"    kParamName_{name}_{lang}," if "Name" in translation else f"    kParamName_{name},")
+                descriptions.append(f"    kParamDescription_{name}_{lang},"
+                                    if "Description" in translation else f"    kParamDescription_{name},")
+                name_lens.append(len(translation.get("Name", "").encode()))
+                desc_lens.append(len(translation.get("Description", "").encode()))
+            languages.append(language.format(lang=lang, index=index))
+            language_tables.append(language_table.format(lang=lang, names="\n".join(names), descriptions="\n".join(descriptions)))
+            language_strings_list.append(language_strings.format(lang=lang))
+
         header_content = header.format(
             n_access_levels=len(self.config.access_levels),
+            max_id=max_id,
             enums='\n'.join(enums),
+            languages="\n".join(languages),
+            n_languages=len(self.config.langs),
             getter_declarations="\n".join(getter_declarations),
             setter_declarations="\n".join(setter_declarations),
+            tx_setter_declarations="\n".join(tx_setter_declarations),
             n_params=len(self.config.parameters),
             categories="\n".join(categories),
             n_categories=len(self.config.categories.keys()),
             category_max_len=max([len(c) for c in self.config.categories.keys()]) + 1, # +1 for null termination
             max_n_params_in_category=max(n_params_in_category),
-            param_name_max_len=max([len(p["Name"]) for p in self.config.parameters.values()]) + 1, # +1 for null termination
-            param_desc_max_len=max([len(p["Description"]) for p in self.config.parameters.values()]) + 1, # +1 for null termination
+            param_name_max_len=max(name_lens) + 1, # +1 for null termination
+            param_desc_max_len=max(desc_lens) + 1, # +1 for null termination
             param_value_string_max_len=max(param_value_string_len) + 2, # +1 for null termination, +1 for decimal
         )
         with open(header_path, 'w') as file_:
             file_.write(header_content)
             
+        # Only for units of parameters, unused static strings would warn
+        used_units = {p["Unit"] for p in self.config.parameters.values() if "Unit" in p}
+        unit_names = [unit_name.format(id=id, display_name=name) for name, id in self.config.units.items()
+                      if name in used_units]
+
         source_content = source.format(
+            unit_names="\n".join(unit_names),
             parameter_initializers='\n'.join(parameter_initializers),
+            param_value_members="\n".join(member for _, member in
+                                           sorted(param_value_members, key=lambda m: -value_type_size[m[0]])),
             category_initializers='\n'.join(category_initializers),
             getter_definitions="\n".join(getter_definitions),
             setter_definitions="\n".join(setter_definitions),
-            get_value_string_funcs="\n".join(get_value_string_funcs),
-            get_value_string_cases="\n".join(get_value_string_cases),
+            tx_setter_definitions="\n".join(tx_setter_definitions),
+            enum_infos="\n".join(enum_infos),
             handle_export_cases="\n".join(handle_export_cases),
-            handle_set_cases="\n".join(handle_set_cases),
-            settings_save_cases="\n".join(settings_save_cases),
+            sorted_settings=sorted_settings,
+            id_to_index=id_to_index_table,
+            schema_hash=f"0x{fnv1a(''.join(blob_fields).encode()):08X}",
+            blob_value_members="\n".join(blob_value_members),
+            blob_fields="\n".join(blob_fields),
+            blob_pack="\n".join(blob_pack),
+            blob_unpack="\n".join(blob_unpack),
+            setting_names="\n".join(setting_names),
             param_names="\n".join(param_names),
             param_descriptions="\n".join(param_descriptions),
             category_names="\n".join(category_names),
-            param_production_default_values="\n    ".join(param_default_values),
-            param_default_overrides="\n".join(param_default_overrides),
+            language_tables="\n".join(language_tables),
+            languages="\n".join(language_strings_list),
+            production_defaults="\n".join(production_defaults),
+            override_params="\n".join(override_params),
+            override_values="\n".join(override_values),
+            machine_overrides="\n".join(machine_overrides),
             parameters_header=header_path.relative_to(os.path.commonprefix([source_path.parent, header_path.parent])),
         )
         with open(source_path, 'w') as file_:
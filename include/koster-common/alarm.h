@@ -6,6 +6,10 @@
 
 #define ALARM_ORIGIN_MASK 0xFF00
 #define ALARM_ERROR_ID_MASK 0x00FF
+// Maximum number of simultaneously active alarms
+#define ALARM_MAX_ALARMS 20
+// Size of a bitmap with one bit per error ID
+#define ALARM_ERROR_BITMAP_SIZE 32
 
 typedef enum {
     kAlarmOriginUnknown = 0,
@@ -17,9 +21,42 @@ typedef enum {
     kAlarmOriginVinga5 = 0x2400,
 } alarm_origin_t;
 
+// Number of bits used in an origin bitmap, see AlarmOriginBit()
+#define ALARM_N_ORIGINS 7
+
+/**
+ * State of an alarm in the active set.
+ */
+typedef enum {
+    /** the condition is present and the alarm has not been acknowledged */
+    kAlarmStateActive = 0x01,
+    /** the condition is present and the alarm has been acknowledged */
+    kAlarmStateAcknowledged = 0x02,
+    /** the condition has gone, but the (type A) alarm stays until acknowledged */
+    kAlarmStateLatched = 0x04,
+} alarm_state_t;
+
+// States in which the alarm condition is present
+#define ALARM_STATE_CONDITION_ACTIVE (kAlarmStateActive | kAlarmStateAcknowledged)
+
 struct alarm_t {
     uint16_t id;
     uint32_t epoch;  // milliseconds
+    uint8_t state;   // alarm_state_t
+};
+
+/**
+ * A consistent copy of the set of active alarms.
+ */
+struct alarm_snapshot {
+    /** incremented every time the set of active alarms changes */
+    uint32_t generation;
+    /** number of valid entries in alarms */
+    uint8_t n_alarms;
+    /** the most important active alarm (see AlarmGetTopActive), id 0 if none */
+    struct alarm_t top;
+    /** the active and latched alarms, in the order they were raised */
+    struct alarm_t alarms[ALARM_MAX_ALARMS];
 };
 
 /**
@@ -38,6 +75,13 @@ char AlarmGetType(uint16_t alarm_id);
 /**
  * @brief Set or clear an alarm alarm.
  *
+ * Raising an alarm that is already active does nothing. If the alarm has a hold-off (see AlarmSetHoldOff), a
+ * clear only takes effect once the alarm has not been raised again for the whole hold-off time. A type A alarm
+ * that has not been acknowledged (see AlarmAcknowledge) is latched when it clears, and stays in the active set.
+ *
+ * Changes are published on kzbus_alarm_chan, coalesced per notification window (see AlarmSetNotifyWindow).
+ * Raising a type A alarm always publishes immediately.
+ *
  * @param active  true to activate the alarm, false to clear
  * @param error_id  the error ID (alarm ID sans origin)
  * @param origin  the origin (alarm ID sans error ID)
@@ -45,9 +89,76 @@ char AlarmGetType(uint16_t alarm_id);
  */
 int AlarmSet(const bool active, const uint8_t error_id, const alarm_origin_t origin);
 
+/**
+ * @brief Set the complete set of active errors for one origin.
+ *
+ * Alarms from the origin that are not in the bitmap are cleared (subject to hold-off) and alarms in the bitmap
+ * that are not active are raised. The whole update is applied under one lock acquisition and the resulting
+ * changes are published together, as one kMsgAlarmBatch message per KZBUS_ALARM_BATCH_MAX_CHANGES changes.
+ *
+ * @param origin         the origin whose errors are reported, e.g. a Vinga node
+ * @param active_bitmap  ALARM_ERROR_BITMAP_SIZE bytes, bit (error_id % 8) of byte (error_id / 8) set if active
+ * @return 0 on success, -1 if not all alarms could be raised, -EINVAL if active_bitmap is NULL
+ */
+int AlarmSetMask(const alarm_origin_t origin, const uint8_t *active_bitmap);
+
+/**
+ * @brief Set the hold-off time of an alarm.
+ *
+ * A cleared alarm stays active until it has not been raised again for hold_off_ms, which suppresses flapping
+ * caused by e.g. a loose sensor. Alarms without an individual hold-off use CONFIG_KOSTER_COMMON_ALARM_HOLD_OFF_MS.
+ *
+ * @param alarm_id     the alarm ID (origin | error_id)
+ * @param hold_off_ms  the hold-off time in milliseconds, 0 to clear immediately
+ * @return 0 on success, -EINVAL on invalid alarm ID, -ENOMEM if too many alarms have a hold-off
+ */
+int AlarmSetHoldOff(const uint16_t alarm_id, const uint16_t hold_off_ms);
+
+/**
+ * @brief Set the notification window.
+ *
+ * Alarm changes within the window are published together as one kMsgAlarmBatch message (or a single kMsgAlarm
+ * message if there was only one change). An alarm raised and cleared within the same window is not published.
+ *
+ * @param window_ms  the window in milliseconds, 0 to publish every change immediately
+ */
+void AlarmSetNotifyWindow(const uint16_t window_ms);
+
+/**
+ * @brief Get the most important active alarm.
+ *
+ * Latched alarms are included. Type A alarms come before type B alarms, which come before alarms of unknown type. Among alarms of the same
+ * type the one raised first wins. The answer is kept up to date by AlarmSet(), so this does not iterate.
+ *
+ * @param[out] alarm  will be set to the most important active alarm
+ *
+ * @return 0 on success, -ENOENT if no alarm is active, -EINVAL if alarm is NULL.
+ */
+int AlarmGetTopActive(struct alarm_t *alarm);
+
+/**
+ * @brief Acknowledge an alarm.
+ *
+ * An alarm whose condition is still present stays active until it clears. A latched alarm is removed.
+ *
+ * @param alarm_id  the alarm ID (origin | error_id)
+ *
+ * @return 0 on success (also if the alarm already was acknowledged), -ENOENT if the alarm is not active.
+ */
+int AlarmAcknowledge(const uint16_t alarm_id);
+
+/**
+ * @brief Acknowledge all active and latched alarms.
+ *
+ * @return the number of alarms that were acknowledged.
+ */
+int AlarmAcknowledgeAll();
+
 /**
  * @brief Check if there are active type A alarms (critical)
  *
+ * Latched type A alarms count as active until they are acknowledged.
+ *
  * @return true if there are type A alarms active, false if not
  */
 bool AlarmActiveTypeAAlarms();
@@ -65,18 +176,80 @@ bool AlarmActiveTypeAAlarms();
 typedef int (*alarm_walk_cb_t)(const struct alarm_t alarm, void *arg);
 
 /**
- * @brief Iterates over each active alarm entry and invokes the provided callback function.
+ * @brief Iterates over each alarm whose condition is present and invokes the provided callback function.
  *
  * @param cb Pointer to a function to be called for each entry
  * @param arg Pointer to user-defined data to be passed to the callback function.
  *
  * @details The function processes all entries, calling the callback for each one if provided.
  *          If the callback returns a non-zero value, the iteration stops early.
+ *          The walk runs over an AlarmSnapshot() copy, so the callback may call AlarmSet().
  *
  * @return 0 on success, -1 if the walk failed or was stopped by callback.
  */
 int AlarmWalk(alarm_walk_cb_t cb, void *arg);
 
+/**
+ * @brief Iterates over the alarms in the given states and invokes the provided callback function.
+ *
+ * AlarmWalk() is the same as AlarmWalkState(ALARM_STATE_CONDITION_ACTIVE, ...).
+ *
+ * @param state_mask  alarm_state_t flags of the alarms to report, e.g. kAlarmStateLatched
+ * @param cb          Pointer to a function to be called for each entry
+ * @param arg         Pointer to user-defined data to be passed to the callback function.
+ *
+ * @return 0 on success, -1 if the walk failed or was stopped by callback.
+ */
+int AlarmWalkState(const uint8_t state_mask, alarm_walk_cb_t cb, void *arg);
+
+/**
+ * @brief Copy the set of active alarms without taking the alarm mutex.
+ *
+ * @details The active set is double-buffered and published under a generation counter, so the copy is
+ *          always consistent and never blocks on AlarmSet(). Intended for frequent polling, e.g. from a GUI.
+ *
+ * @param[out] snapshot  will be filled with the active alarms
+ *
+ * @return 0 on success, -EINVAL if snapshot is NULL.
+ */
+int AlarmSnapshot(struct alarm_snapshot *snapshot);
+
+/**
+ * @brief Get the bit of an origin in an origin bitmap.
+ *
+ * kAlarmOriginKoster is bit 0, kAlarmOriginVinga1 to kAlarmOriginVinga5 are bits 1 to 5, and any other origin
+ * is bit 6.
+ *
+ * @param origin  the origin (alarm ID sans error ID)
+ * @return the bitmap with only the bit of origin set
+ */
+uint8_t AlarmOriginBit(const alarm_origin_t origin);
+
+/**
+ * @brief Test if an alarm from a specific origin is active.
+ *
+ * @param origin    the origin (alarm ID sans error ID)
+ * @param error_id  the error ID (alarm ID sans origin)
+ * @return true if the condition of the alarm is present, false if not
+ */
+bool AlarmIsActiveFrom(const alarm_origin_t origin, const uint8_t error_id);
+
+/**
+ * @brief Get the origins that have an error active.
+ *
+ * @param error_id  the error ID (alarm ID sans origin)
+ * @return bitmap of the origins (see AlarmOriginBit) with the error condition present, 0 if none
+ */
+uint8_t AlarmOriginsWithError(const uint8_t error_id);
+
+/**
+ * @brief Count the active alarms from an origin.
+ *
+ * @param origin  the origin (alarm ID sans error ID)
+ * @return the number of alarms from origin whose condition is present
+ */
+uint8_t AlarmCountByOrigin(const alarm_origin_t origin);
+
 /**
  * @brief Test if an alarm is active
  *
@@ -0,0 +1,79 @@
+#ifndef KOSTER_COMMON_ALARM_JOURNAL_H
+#define KOSTER_COMMON_ALARM_JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * An alarm raise or clear, as recorded in the journal.
+ */
+struct alarm_journal_event_t {
+    /** RTC time of the change, Unix epoch in seconds */
+    uint32_t epoch;
+    /** the alarm ID (origin | error_id) */
+    uint16_t alarm_id;
+    /** 1 if the alarm was raised, 0 if it was cleared */
+    uint8_t active;
+    uint8_t reserved;
+};
+
+/**
+ * @brief Initialize the alarm journal and open its flash partition.
+ *
+ * Events are buffered in RAM and written to flash one sector-sized batch at a time, when the buffer is full,
+ * periodically, or on AlarmJournalFlush(). Recording an event never writes to flash directly.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int AlarmJournalInit();
+
+/**
+ * @brief Record an alarm event in the RAM buffer.
+ *
+ * Called by AlarmSet(). When the buffer becomes full a flush is submitted to the system work queue.
+ *
+ * @param active    true if the alarm was raised, false if it was cleared
+ * @param alarm_id  the alarm ID (origin | error_id)
+ * @param epoch     RTC time of the change
+ *
+ * @return 0 on success, -ENOMEM if the buffer is full and the event was dropped.
+ */
+int AlarmJournalRecord(const bool active, const uint16_t alarm_id, const uint32_t epoch);
+
+/**
+ * @brief Write all buffered events to flash as one batch.
+ *
+ * Call before a controlled reboot so that no events are lost.
+ *
+ * @return 0 on success (also when there was nothing to write), negative error code on failure.
+ */
+int AlarmJournalFlush();
+
+/**
+ * @brief Callback function type for AlarmJournalQuery.
+ *
+ * @param event  the matching event
+ * @param arg    User-defined argument passed from input to AlarmJournalQuery
+ *
+ * @return 0 to continue iteration, non-zero to stop.
+ */
+typedef int (*alarm_journal_cb_t)(const struct alarm_journal_event_t *event, void *arg);
+
+/**
+ * @brief Iterate over journal events, oldest first, in flash and in the RAM buffer.
+ *
+ * @param from_epoch  only events with epoch >= from_epoch are reported
+ * @param to_epoch    only events with epoch <= to_epoch are reported
+ * @param alarm_id    only events for this alarm ID are reported, or 0 for all alarms
+ * @param cb          called for each matching event
+ * @param arg         Pointer to user-defined data to be passed to the callback function.
+ *
+ * @return the number of events reported, or negative error code on failure.
+ */
+int AlarmJournalQuery(const uint32_t from_epoch,
+                      const uint32_t to_epoch,
+                      const uint16_t alarm_id,
+                      alarm_journal_cb_t cb,
+                      void *arg);
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef KOSTER_COMMON_ALARM_STATS_H
+#define KOSTER_COMMON_ALARM_STATS_H
+
+#include <stdint.h>
+
+// Maximum number of distinct alarm IDs with statistics, must be a power of two
+#define ALARM_STATS_MAX_ALARMS 64
+
+/**
+ * Occurrence statistics of one alarm ID.
+ */
+struct alarm_stats_t {
+    /** the alarm ID (origin | error_id) */
+    uint16_t alarm_id;
+    /** number of times the alarm was raised */
+    uint32_t count;
+    /** total time the alarm has been active, in ms, including the current activation */
+    uint64_t active_ms;
+};
+
+/**
+ * @brief Load the alarm statistics from settings and start persisting them periodically.
+ *
+ * Statistics are collected from AlarmInit() on; AlarmStatsInit() adds the counts stored before the last reboot.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int AlarmStatsInit();
+
+/**
+ * @brief Get the statistics of one alarm.
+ *
+ * @param alarm_id  the alarm ID (origin | error_id)
+ * @param stats     filled with the statistics of the alarm
+ *
+ * @return 0 on success, -ENOENT if the alarm has never been raised.
+ */
+int AlarmStatsGet(const uint16_t alarm_id, struct alarm_stats_t *stats);
+
+/**
+ * @brief Callback function type for AlarmStatsWalk.
+ *
+ * @param stats  the statistics of one alarm
+ * @param arg    User-defined argument passed from input to AlarmStatsWalk
+ *
+ * @return 0 to continue iteration, non-zero to stop.
+ */
+typedef int (*alarm_stats_cb_t)(const struct alarm_stats_t *stats, void *arg);
+
+/**
+ * @brief Iterate over the statistics of all alarms that have been raised, in no particular order.
+ *
+ * The callback is called without any alarm lock held and may call AlarmSet().
+ *
+ * @param cb   called for each alarm
+ * @param arg  Pointer to user-defined data to be passed to the callback function.
+ *
+ * @return the number of alarms reported.
+ */
+int AlarmStatsWalk(alarm_stats_cb_t cb, void *arg);
+
+/**
+ * @brief Store the alarm statistics in settings now.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int AlarmStatsPersist();
+
+/**
+ * @brief Clear all alarm statistics, in RAM and in settings.
+ *
+ * Alarms that are active keep counting their active time from now on.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int AlarmStatsReset();
+
+#endif
@@ -8,6 +8,10 @@
 #include "koster-common/alarm.h"
 
 #define ZBUS_SENDER_NAME_MAX_LEN 16
+// Maximum number of alarm changes in one kzbus_alarm_batch_msg_t
+#define KZBUS_ALARM_BATCH_MAX_CHANGES 8
+// Parameter Ids in kzbus_param_msg_t range from 0 to KZBUS_PARAM_MAX_IDS - 1
+#define KZBUS_PARAM_MAX_IDS 256
 
 /**
  * Sent to the Runner to request a program to start. Sent on channel kzbus_control_chan.
@@ -101,6 +105,17 @@ struct kzbus_alarm_msg_t {
     uint16_t alarm_id;
 };
 
+/**
+ * Sent from the Runner when several alarms changed within one notification window. Sent on channel
+ * kzbus_alarm_chan. Changes are listed in the order they happened; if there are more than
+ * KZBUS_ALARM_BATCH_MAX_CHANGES, several batch messages are sent back to back.
+ */
+struct kzbus_alarm_batch_msg_t {
+    /** number of valid entries in changes */
+    uint8_t n_changes;
+    struct kzbus_alarm_msg_t changes[KZBUS_ALARM_BATCH_MAX_CHANGES];
+};
+
 /**
  * Sent from the Runner. Sent on channel kzbus_ircam_chan.
  */
@@ -112,6 +127,20 @@ struct kzbus_ircam_msg_t {
     uint8_t vinga_id;
 };
 
+/**
+ * Sent when parameter values changed, from any setter or when loaded from storage. Sent on channel
+ * kzbus_param_chan. Changes within the notification window are collected in one message; a parameter is
+ * listed once however often it changed.
+ */
+struct kzbus_param_msg_t {
+    /** number of parameters set in changed_ids */
+    uint16_t n_changed;
+    /** bit (id % 8) of byte (id / 8) is set if the parameter with this Id changed */
+    uint8_t changed_ids[KZBUS_PARAM_MAX_IDS / 8];
+    /** a parameter with an Id of KZBUS_PARAM_MAX_IDS or more changed, these are not in changed_ids */
+    bool other_changed;
+};
+
 /**
  * Encodes the message type of kzbus_msg_t
  */
@@ -124,7 +153,9 @@ typedef enum {
     kMsgTemperature,
     kMsgDistance,
     kMsgIRCamera,
-    kMsgAlarm
+    kMsgAlarm,
+    kMsgAlarmBatch,
+    kMsgParamChanged
 } kzbus_msg_type_t;
 
 /**
@@ -146,7 +177,9 @@ struct kzbus_msg_t {
         struct kzbus_temperature_msg_t temperature_msg;
         struct kzbus_distance_msg_t distance_msg;
         struct kzbus_alarm_msg_t alarm_msg;
+        struct kzbus_alarm_batch_msg_t alarm_batch_msg;
         struct kzbus_ircam_msg_t ircam_msg;
+        struct kzbus_param_msg_t param_msg;
     };
 };
 
@@ -161,7 +194,8 @@ ZBUS_CHAN_DECLARE(kzbus_program_chan,      // Channel for program state messages
                   kzbus_distance_chan,     // Channel for distance messages (from program runner)
                   kzbus_alarm_chan,        // Channel for alarm messages (from program runner)
                   kzbus_control_chan,      // Channel for control messages (to program runner)
-                  kzbus_ircam_chan         // Channel for IR camera (from program runner)
+                  kzbus_ircam_chan,        // Channel for IR camera (from program runner)
+                  kzbus_param_chan         // Channel for parameter changes (from parameters)
 );
 
 #endif
@@ -6,12 +6,16 @@
 
 struct param_t;
 struct param_category_t;
+struct param_snapshot;
+struct param_row;
 
 // NOTE: Some of these functions are defined in generated code.
 
 /**
  * Initialize Parameters and read from persistent storage
  *
+ * Calls settings_load(), so the settings of every handler registered before ParamInit() are loaded as well.
+ *
  * @return 0 on success, -1 on failure.
  */
 int ParamInit();
@@ -39,6 +43,35 @@ int32_t ParamGetValue(const struct param_t* param);
  */
 int ParamGetId(const struct param_t* param);
 
+/**
+ * Find a parameter by its Id, as used in program history and by remote tools
+ *
+ * @param id  the parameter Id from the parameter configuration
+ *
+ * @return pointer to the parameter, or NULL if there is no parameter with this Id
+ */
+const struct param_t* ParamFindById(const int id);
+
+/**
+ * Get parameter value by Id
+ *
+ * @param id          the parameter Id
+ * @param[out] value  the value of the parameter
+ *
+ * @return 0 on success, -1 if there is no parameter with this Id
+ */
+int ParamGetById(const int id, int32_t* value);
+
+/**
+ * Set parameter value by Id
+ *
+ * @param id     the parameter Id
+ * @param value  the new value
+ *
+ * @return 0 on success, -1 if there is no parameter with this Id or the value is out of range
+ */
+int ParamSetById(const int id, const int32_t value);
+
 /**
  * Get minimum parameter value
  *
@@ -84,6 +117,113 @@ int ParamDecreaseValue(const struct param_t* param);
  */
 int ParamSetValue(const struct param_t* param, const int32_t value);
 
+#define PARAM_TX_MAX_CHANGES 16
+
+/**
+ * A set of parameter changes staged with ParamTxSet() and applied together by ParamTxCommit()
+ */
+struct param_tx {
+    unsigned int n_changes;
+    bool failed;  // a ParamTxSet() failed, ParamTxCommit() applies nothing
+    struct {
+        const struct param_t* param;
+        int32_t value;
+    } changes[PARAM_TX_MAX_CHANGES];
+};
+
+/**
+ * Start a parameter transaction
+ *
+ * @param tx  the transaction, usually on the caller's stack
+ */
+void ParamTxBegin(struct param_tx* tx);
+
+/**
+ * Stage a parameter value in a transaction
+ *
+ * The value is range checked now but only applied by ParamTxCommit(). Generated ParamTxSet<Name>() functions
+ * stage a value by parameter name.
+ *
+ * @return 0 on success, -1 if the value is out of range or the transaction is full (the commit will fail)
+ * @param tx     the transaction
+ * @param param  pointer to the parameter
+ * @param value  the value to set
+ */
+int ParamTxSet(struct param_tx* tx, const struct param_t* param, const int32_t value);
+
+/**
+ * Apply all values staged in a transaction
+ *
+ * The values are stored under one lock, so ParamFlush() and other holders of the parameter lock never see
+ * part of the transaction, nor do readers that use ParamReadBegin(). The changes are published in one
+ * kMsgParamChanged message and saved by one write-behind flush. The transaction is empty afterwards and can be
+ * reused.
+ *
+ * @return 0 on success, -1 if a ParamTxSet() failed, in which case no value is changed
+ * @param tx  the transaction
+ */
+int ParamTxCommit(struct param_tx* tx);
+
+/**
+ * Apply all values staged in a transaction without marking them as unsaved
+ *
+ * Like ParamTxCommit(), but write-behind does not save the values and ParamHasUnsavedChanges() does not report
+ * them. For values that are taken from elsewhere, such as the date and time from the RTC.
+ *
+ * @return 0 on success, -1 if a ParamTxSet() failed, in which case no value is changed
+ * @param tx  the transaction
+ */
+int ParamTxApply(struct param_tx* tx);
+
+/**
+ * Start reading several parameter values that must belong together
+ *
+ * The getters do not lock, so they may return some values from before and some from after a transaction that
+ * is being applied. Read the values between ParamReadBegin() and ParamReadRetry(), and read them again while
+ * ParamReadRetry() returns true:
+ *
+ *     unsigned int seq;
+ *     do {
+ *         seq = ParamReadBegin();
+ *         hour = ParamGetHour();
+ *         minute = ParamGetMinute();
+ *     } while (ParamReadRetry(seq));
+ *
+ * @return the sequence to pass to ParamReadRetry()
+ */
+unsigned int ParamReadBegin();
+
+/**
+ * Check if the values read since ParamReadBegin() may be part of a transaction, see ParamReadBegin()
+ *
+ * @return true if the values must be read again
+ * @param seq  returned by ParamReadBegin()
+ */
+bool ParamReadRetry(const unsigned int seq);
+
+/**
+ * Copy all parameter values
+ *
+ * The values are copied under the parameter lock, so a transaction, ParamLoadDefaults() or ParamRestore() is
+ * either fully in the copy or not at all. Compare the generation of two snapshots to see if any value changed
+ * in between.
+ *
+ * @return 0 on success, -1 on failure
+ * @param[out] snapshot  will be filled with the values
+ */
+int ParamSnapshot(struct param_snapshot* snapshot);
+
+/**
+ * Set all parameters back to the values in a snapshot, e.g. to roll back a failed factory setup
+ *
+ * Like ParamTxCommit(), the values are stored under one lock, and the parameters that differ from the snapshot
+ * are published in one kMsgParamChanged message and saved by one write-behind flush.
+ *
+ * @return the number of parameters changed, or -1 on failure
+ * @param snapshot  a snapshot taken with ParamSnapshot()
+ */
+int ParamRestore(const struct param_snapshot* snapshot);
+
 /**
  * Check if parameter is an enum
  *
@@ -92,6 +232,17 @@ int ParamSetValue(const struct param_t* param, const int32_t value);
  */
 bool ParamIsEnum(const struct param_t* param);
 
+/**
+ * Select the language of parameter names and descriptions
+ *
+ * Takes effect immediately for ParamGetName(), ParamNamePtr(), ParamDescriptionPtr() and ParamRowWalk(). Pointers
+ * returned before stay valid. Parameters without a translation keep their English name or description.
+ *
+ * @return 0 on success, -1 if the language is unknown
+ * @param language  one of kParamLang<Lang>, as in LanguageOverride in the parameter configuration
+ */
+int ParamSelectLanguage(const unsigned int language);
+
 /**
  * Get name of parameter
  *
@@ -101,6 +252,63 @@ bool ParamIsEnum(const struct param_t* param);
  */
 int ParamGetName(const struct param_t* param, char* buf);
 
+/**
+ * Get name of parameter without copying it
+ *
+ * @return the name in the current language, valid for the lifetime of the program, or "" if param is NULL
+ * @param param  pointer to the parameter
+ */
+const char* ParamNamePtr(const struct param_t* param);
+
+/**
+ * Get description of parameter without copying it
+ *
+ * @return the description in the current language, valid for the lifetime of the program, or "" if param is
+ *         NULL
+ * @param param  pointer to the parameter
+ */
+const char* ParamDescriptionPtr(const struct param_t* param);
+
+/**
+ * Get the label of an enum parameter value without copying it
+ *
+ * @return the label (as ParamGetValueString() formats it), valid for the lifetime of the program, or NULL if
+ *         the parameter is not an enum or the value is not in the enum
+ * @param param  pointer to the parameter
+ * @param value  the enum value
+ */
+const char* ParamEnumLabelPtr(const struct param_t* param, const int32_t value);
+
+/**
+ * Get the labels of all values of an enum parameter, for an LVGL roller or dropdown
+ *
+ * Use ParamEnumValueToRow() and ParamEnumRowToValue() to convert between the selected line and the value.
+ *
+ * @return the labels in value order separated by '\n', valid for the lifetime of the program, or NULL if the
+ *         parameter is not an enum
+ * @param param  pointer to the parameter
+ */
+const char* ParamGetEnumOptions(const struct param_t* param);
+
+/**
+ * Get the line of an enum value in ParamGetEnumOptions()
+ *
+ * @return the line, or -1 if the parameter is not an enum or the value is not in the enum
+ * @param param  pointer to the parameter
+ * @param value  the enum value
+ */
+int ParamEnumValueToRow(const struct param_t* param, const int32_t value);
+
+/**
+ * Get the enum value of a line in ParamGetEnumOptions()
+ *
+ * @return 0 on success, -1 if the parameter is not an enum or there is no such line
+ * @param param       pointer to the parameter
+ * @param row         the line
+ * @param[out] value  the enum value
+ */
+int ParamEnumRowToValue(const struct param_t* param, const unsigned int row, int32_t* value);
+
 /**
  * Get a parameter category by alphabetical index
  *
@@ -119,6 +327,14 @@ int ParamGetCategory(const struct param_category_t** category, const unsigned in
  */
 int ParamGetCategoryName(const struct param_category_t* category, char* buf);
 
+/**
+ * Get name of category without copying it
+ *
+ * @return the name, valid for the lifetime of the program, or "" if category is NULL
+ * @param category  pointer to the category
+ */
+const char* ParamCategoryNamePtr(const struct param_category_t* category);
+
 /**
  * Get number of parameters in category at the specified access level
  *
@@ -177,6 +393,16 @@ int ParamGetValueString(const struct param_t* param, char* buf, const int32_t va
  */
 int ParamGetExponent(const struct param_t* param);
 
+/**
+ * Get the unit of a parameter
+ *
+ * The value string from ParamGetValueString() does not include the unit, append it where the unit is shown.
+ *
+ * @return the unit name from the parameter configuration, or "" if the parameter has no unit
+ * @param param  pointer to the parameter
+ */
+const char* ParamGetUnit(const struct param_t* param);
+
 /**
  * Save a parameter to persistent storage
  *
@@ -185,6 +411,27 @@ int ParamGetExponent(const struct param_t* param);
  */
 int ParamSave(const struct param_t* param);
 
+/**
+ * Save all parameters changed since they were last saved, in one pass over the settings storage
+ *
+ * Every setter marks the parameter as changed, so after changing several values (or loading defaults) one
+ * call persists them all. Values loaded from storage are not marked.
+ *
+ * With CONFIG_KOSTER_COMMON_PARAM_WRITE_BEHIND this is done from the system work queue after changes settle
+ * and when a program start is requested. Call it before a controlled reboot so that no change is lost.
+ *
+ * @return the number of parameters saved, or negative error code on failure (the parameters not saved stay
+ *         marked as changed)
+ */
+int ParamFlush();
+
+/**
+ * Check if any parameter was changed since it was last saved
+ *
+ * @return true if ParamFlush() has anything to save
+ */
+bool ParamHasUnsavedChanges();
+
 /**
  * @brief Callback function type for walking through categories
  *
@@ -230,4 +477,31 @@ typedef int (*param_walk_cb_t)(const struct param_t* parameter, void* arg);
  */
 int ParamWalk(param_walk_cb_t cb, const struct param_category_t* category, const unsigned int access_level, void* arg);
 
+/**
+ * @brief Callback function type for walking through the rows of a category
+ *
+ * @param row  the parameter, valid during the call only
+ *
+ * @return 0 to continue iteration, negative to stop.
+ */
+typedef int (*param_row_walk_cb_t)(const struct param_row* row, void* arg);
+
+/**
+ * @brief Walk through parameters in a category in alphabetic order, with everything needed to show them
+ *
+ * The values of all parameters in the category are read under one lock, so the rows are consistent with each
+ * other. The callback runs without the lock and may change parameters.
+ *
+ * @param cb        callback called for each parameter
+ * @param category  The category
+ * @param access    parameter access level
+ * @param arg       Pointer to user-defined data to be passed to the callback function.
+ *
+ * @return 0 on success, negative on error
+ */
+int ParamRowWalk(param_row_walk_cb_t cb,
+                 const struct param_category_t* category,
+                 const unsigned int access_level,
+                 void* arg);
+
 #endif
@@ -3,25 +3,536 @@
 #include <memory.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
 #include <zephyr/zbus/zbus.h>
 
+#include "alarm_private.h"
 #include "koster-common/koster-zbus.h"
 #include "koster-common/rtc.h"
+#if defined(CONFIG_KOSTER_COMMON_ALARM_JOURNAL)
+#include "koster-common/alarm_journal.h"
+#endif
 
 LOG_MODULE_DECLARE(koster_common);
 
-#define ALARM_MAX_ALARMS 20
+#if defined(CONFIG_KOSTER_COMMON_ALARM_HOLD_OFF_MS)
+#define ALARM_DEFAULT_HOLD_OFF_MS CONFIG_KOSTER_COMMON_ALARM_HOLD_OFF_MS
+#else
+#define ALARM_DEFAULT_HOLD_OFF_MS 0
+#endif
+
+#if defined(CONFIG_KOSTER_COMMON_ALARM_NOTIFY_WINDOW_MS)
+#define ALARM_DEFAULT_NOTIFY_WINDOW_MS CONFIG_KOSTER_COMMON_ALARM_NOTIFY_WINDOW_MS
+#else
+#define ALARM_DEFAULT_NOTIFY_WINDOW_MS 0
+#endif
+
+// Maximum number of alarms with an individual hold-off time
+#define ALARM_MAX_HOLD_OFFS 16
+// Maximum number of alarm changes waiting for the notification window to close
+#define ALARM_MAX_PENDING_NOTIFICATIONS (2 * ALARM_MAX_ALARMS)
+
+// Index of an empty alarm list, or the end of one
+#define ALARM_NO_SLOT -1
 
 struct k_mutex alarm_mutex_;
 static uint16_t active_alarms_[ALARM_MAX_ALARMS];
 static uint32_t active_alarm_times_[ALARM_MAX_ALARMS];
+static int64_t clear_deadlines_[ALARM_MAX_ALARMS];  // uptime (ms) when a held-off clear takes effect, 0 if none
+static uint8_t alarm_states_[ALARM_MAX_ALARMS];     // alarm_state_t of each used slot
+
+// Index of the alarms whose condition is present, by error ID and by origin (see AlarmOriginBit)
+static uint8_t error_origins_[ALARM_ERROR_ID_MASK + 1];
+static uint8_t origin_counts_[ALARM_N_ORIGINS];
+
+// Active slots are linked into one list per alarm type, in the order they were raised, so the most
+// important alarm is always the head of the first non-empty list.
+enum alarm_list_id {
+    kAlarmListTypeA,
+    kAlarmListTypeB,
+    kAlarmListTypeU,
+    kAlarmNumLists,
+};
+struct alarm_list {
+    int8_t head;
+    int8_t tail;
+};
+static struct alarm_list alarm_lists_[kAlarmNumLists];
+static int8_t next_slot_[ALARM_MAX_ALARMS];
+static int8_t prev_slot_[ALARM_MAX_ALARMS];
+static uint8_t slot_list_[ALARM_MAX_ALARMS];
+
+// Readers copy snapshots_[generation & 1] while AlarmSet() fills the other buffer under alarm_mutex_.
+// A reader retries if the generation moved while it was copying.
+static struct alarm_snapshot snapshots_[2];
+static atomic_t snapshot_generation_;
+
+struct alarm_hold_off {
+    uint16_t alarm_id;
+    uint16_t hold_off_ms;
+};
+static struct alarm_hold_off hold_offs_[ALARM_MAX_HOLD_OFFS];
+static struct k_work_delayable clear_work_;
+
+struct pending_notification {
+    struct kzbus_alarm_msg_t change;
+    bool was_active;  // state of the alarm before the first queued change
+};
+static struct pending_notification pending_[ALARM_MAX_PENDING_NOTIFICATIONS];
+static uint8_t n_pending_;
+static uint32_t pending_epoch_;  // epoch of the latest queued change
+static uint16_t notify_window_ms_;
+static struct k_work_delayable notify_work_;
 
 extern const struct zbus_channel kzbus_alarm_chan;
 
+static enum alarm_list_id get_list_id(const uint16_t alarm_id) {
+    switch (AlarmGetType(alarm_id)) {
+        case 'A':
+            return kAlarmListTypeA;
+        case 'B':
+            return kAlarmListTypeB;
+        default:
+            return kAlarmListTypeU;
+    }
+}
+
+/**
+ * Append a slot to the list of its alarm type. Must be called with alarm_mutex_ held.
+ */
+static void link_slot(const int index) {
+    const enum alarm_list_id list_id = get_list_id(active_alarms_[index]);
+    struct alarm_list *list = &alarm_lists_[list_id];
+
+    slot_list_[index] = list_id;
+    next_slot_[index] = ALARM_NO_SLOT;
+    prev_slot_[index] = list->tail;
+    if (list->tail == ALARM_NO_SLOT) {
+        list->head = index;
+    } else {
+        next_slot_[list->tail] = index;
+    }
+    list->tail = index;
+}
+
+/**
+ * Remove a slot from the list of its alarm type. Must be called with alarm_mutex_ held.
+ */
+static void unlink_slot(const int index) {
+    struct alarm_list *list = &alarm_lists_[slot_list_[index]];
+
+    if (prev_slot_[index] == ALARM_NO_SLOT) {
+        list->head = next_slot_[index];
+    } else {
+        next_slot_[prev_slot_[index]] = next_slot_[index];
+    }
+    if (next_slot_[index] == ALARM_NO_SLOT) {
+        list->tail = prev_slot_[index];
+    } else {
+        prev_slot_[next_slot_[index]] = prev_slot_[index];
+    }
+}
+
+/**
+ * @return the slot of the most important active alarm, or ALARM_NO_SLOT. Must be called with alarm_mutex_ held.
+ */
+static int top_slot() {
+    for (int i = 0; i < kAlarmNumLists; ++i) {
+        if (alarm_lists_[i].head != ALARM_NO_SLOT) {
+            return alarm_lists_[i].head;
+        }
+    }
+    return ALARM_NO_SLOT;
+}
+
+/**
+ * Publish the current active set to readers. Must be called with alarm_mutex_ held.
+ */
+static void publish_snapshot() {
+    const atomic_val_t generation = atomic_get(&snapshot_generation_) + 1;
+    struct alarm_snapshot *snapshot = &snapshots_[generation & 1];
+
+    snapshot->generation = (uint32_t)generation;
+    snapshot->n_alarms = 0;
+    for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
+        if (active_alarms_[i] != 0) {
+            snapshot->alarms[snapshot->n_alarms].id = active_alarms_[i];
+            snapshot->alarms[snapshot->n_alarms].epoch = active_alarm_times_[i];
+            snapshot->alarms[snapshot->n_alarms].state = alarm_states_[i];
+            ++snapshot->n_alarms;
+        }
+    }
+
+    const int top = top_slot();
+    snapshot->top.id = top == ALARM_NO_SLOT ? 0 : active_alarms_[top];
+    snapshot->top.epoch = top == ALARM_NO_SLOT ? 0 : active_alarm_times_[top];
+    snapshot->top.state = top == ALARM_NO_SLOT ? 0 : alarm_states_[top];
+
+    atomic_set(&snapshot_generation_, generation);
+}
+
+/**
+ * Publish all queued alarm changes. Must be called without alarm_mutex_ held.
+ */
+static void publish_notifications() {
+    struct pending_notification pending[ALARM_MAX_PENDING_NOTIFICATIONS];
+    uint8_t n_pending = 0;
+    uint32_t epoch = 0;
+
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        n_pending = n_pending_;
+        epoch = pending_epoch_;
+        memcpy(pending, pending_, n_pending * sizeof(struct pending_notification));
+        n_pending_ = 0;
+        k_mutex_unlock(&alarm_mutex_);
+    }
+
+    struct kzbus_msg_t alarm_msg;
+    alarm_msg.epoch_time = epoch;
+
+    if (n_pending == 1) {
+        alarm_msg.msg_type = kMsgAlarm;
+        alarm_msg.alarm_msg = pending[0].change;
+        zbus_chan_pub(&kzbus_alarm_chan, &alarm_msg, K_NO_WAIT);
+        return;
+    }
+
+    alarm_msg.msg_type = kMsgAlarmBatch;
+    for (uint8_t i = 0; i < n_pending; i += KZBUS_ALARM_BATCH_MAX_CHANGES) {
+        alarm_msg.alarm_batch_msg.n_changes = MIN(KZBUS_ALARM_BATCH_MAX_CHANGES, n_pending - i);
+        for (uint8_t j = 0; j < alarm_msg.alarm_batch_msg.n_changes; ++j) {
+            alarm_msg.alarm_batch_msg.changes[j] = pending[i + j].change;
+        }
+        zbus_chan_pub(&kzbus_alarm_chan, &alarm_msg, K_NO_WAIT);
+    }
+}
+
+static void notify_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    publish_notifications();
+}
+
+/**
+ * Queue an alarm change for notification. Must be called with alarm_mutex_ held.
+ *
+ * @return true if the queue must be published right away
+ */
+static bool queue_notification(const bool active, const uint16_t alarm_id, const uint32_t epoch) {
+    pending_epoch_ = epoch;
+
+    for (uint8_t i = 0; i < n_pending_; ++i) {
+        if (pending_[i].change.alarm_id != alarm_id) {
+            continue;
+        }
+        if (pending_[i].was_active == active) {
+            // Toggled back within the window, there is nothing to report
+            memmove(&pending_[i], &pending_[i + 1], (n_pending_ - i - 1) * sizeof(struct pending_notification));
+            --n_pending_;
+        } else {
+            pending_[i].change.alarm_active = active;
+        }
+        return notify_window_ms_ == 0;
+    }
+
+    pending_[n_pending_].change.alarm_active = active;
+    pending_[n_pending_].change.alarm_id = alarm_id;
+    pending_[n_pending_].was_active = !active;
+    ++n_pending_;
+
+    if (notify_window_ms_ == 0 || n_pending_ == ALARM_MAX_PENDING_NOTIFICATIONS) {
+        return true;
+    }
+
+    k_work_schedule(&notify_work_, K_MSEC(notify_window_ms_));
+    return false;
+}
+
+/**
+ * @return the position of an origin in error_origins_ bitmaps and origin_counts_
+ */
+static int get_origin_index(const uint16_t origin) {
+    switch (origin) {
+        case kAlarmOriginKoster:
+            return 0;
+        case kAlarmOriginVinga1:
+        case kAlarmOriginVinga2:
+        case kAlarmOriginVinga3:
+        case kAlarmOriginVinga4:
+        case kAlarmOriginVinga5:
+            return 1 + ((origin - kAlarmOriginVinga1) >> 8);
+        default:
+            return ALARM_N_ORIGINS - 1;
+    }
+}
+
+/**
+ * Record that the condition of an alarm appeared or went away. Must be called with alarm_mutex_ held.
+ */
+static void record_condition(const bool active, const uint16_t alarm_id, const uint32_t epoch, const int64_t now) {
+    const int origin_index = get_origin_index(alarm_id & ALARM_ORIGIN_MASK);
+    const uint8_t origin_bit = 1 << origin_index;
+    if (active) {
+        error_origins_[alarm_id & ALARM_ERROR_ID_MASK] |= origin_bit;
+        ++origin_counts_[origin_index];
+    } else {
+        error_origins_[alarm_id & ALARM_ERROR_ID_MASK] &= ~origin_bit;
+        --origin_counts_[origin_index];
+    }
+
+    alarm_stats_record(active, alarm_id, now);
+#if defined(CONFIG_KOSTER_COMMON_ALARM_JOURNAL)
+    AlarmJournalRecord(active, alarm_id, epoch);
+#else
+    ARG_UNUSED(epoch);
+#endif
+}
+
+/**
+ * Record a change of the active set. Must be called with alarm_mutex_ held.
+ *
+ * @return true if notifications must be published right away
+ */
+static bool record_change(const bool active, const uint16_t alarm_id, const uint32_t epoch, const int64_t now) {
+    publish_snapshot();
+    record_condition(active, alarm_id, epoch, now);
+    return queue_notification(active, alarm_id, epoch);
+}
+
+static uint16_t get_hold_off(const uint16_t alarm_id) {
+    for (int i = 0; i < ALARM_MAX_HOLD_OFFS; ++i) {
+        if (hold_offs_[i].alarm_id == alarm_id) {
+            return hold_offs_[i].hold_off_ms;
+        }
+    }
+    return ALARM_DEFAULT_HOLD_OFF_MS;
+}
+
+/**
+ * Schedule clear_work_ for the earliest held-off clear. Must be called with alarm_mutex_ held.
+ */
+static void schedule_clear_work(const int64_t now) {
+    int64_t earliest = INT64_MAX;
+    for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
+        if (clear_deadlines_[i] != 0 && clear_deadlines_[i] < earliest) {
+            earliest = clear_deadlines_[i];
+        }
+    }
+
+    if (earliest != INT64_MAX) {
+        k_work_reschedule(&clear_work_, K_MSEC(MAX(earliest - now, 0)));
+    }
+}
+
+/**
+ * Free a slot of the active set. Must be called with alarm_mutex_ held.
+ */
+static void release_slot(const int index) {
+    unlink_slot(index);
+    active_alarms_[index] = 0;
+    active_alarm_times_[index] = 0;
+    clear_deadlines_[index] = 0;
+    alarm_states_[index] = 0;
+}
+
+/**
+ * The condition of an alarm has gone. Removes it from the active set, unless it is an unacknowledged type A
+ * alarm, which is latched until acknowledged. Must be called with alarm_mutex_ held.
+ *
+ * @return true if notifications must be published right away
+ */
+static bool remove_alarm(const int index, const int64_t now, const uint32_t epoch) {
+    const uint16_t alarm_id = active_alarms_[index];
+
+    if (alarm_states_[index] == kAlarmStateActive && AlarmGetType(alarm_id) == 'A') {
+        LOG_INF("[alarm] Alarm ID 0x%X cleared, latched until acknowledged", alarm_id);
+        alarm_states_[index] = kAlarmStateLatched;
+        clear_deadlines_[index] = 0;
+        publish_snapshot();
+        record_condition(false, alarm_id, epoch, now);
+        return false;
+    }
+
+    LOG_INF("[alarm] Clearing alarm ID 0x%X", alarm_id);
+    release_slot(index);
+    return record_change(false, alarm_id, epoch, now);
+}
+
+/**
+ * Acknowledge the alarm in a slot. A latched alarm is removed from the active set. Must be called with
+ * alarm_mutex_ held.
+ *
+ * @return true if the alarm was acknowledged, false if it already was
+ */
+static bool acknowledge_at(const int index, const uint32_t epoch, bool *publish) {
+    const uint16_t alarm_id = active_alarms_[index];
+
+    switch (alarm_states_[index]) {
+        case kAlarmStateActive:
+            LOG_INF("[alarm] Alarm ID 0x%X acknowledged", alarm_id);
+            alarm_states_[index] = kAlarmStateAcknowledged;
+            return true;
+        case kAlarmStateLatched:
+            LOG_INF("[alarm] Alarm ID 0x%X acknowledged, clearing", alarm_id);
+            release_slot(index);
+            // The condition was recorded when the alarm latched, only the active set changes now
+            *publish |= queue_notification(false, alarm_id, epoch);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void clear_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    bool publish = false;
+    const uint32_t epoch = RtcGetEpoch();
+
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        const int64_t now = k_uptime_get();
+        for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
+            if (clear_deadlines_[i] != 0 && clear_deadlines_[i] <= now) {
+                publish |= remove_alarm(i, now, epoch);
+            }
+        }
+        schedule_clear_work(now);
+        k_mutex_unlock(&alarm_mutex_);
+    }
+
+    if (publish) {
+        publish_notifications();
+    }
+}
+
+/**
+ * Raise an alarm. Must be called with alarm_mutex_ held.
+ */
+static int raise_alarm(const uint16_t alarm_id, const int64_t now, const uint32_t epoch, bool *publish) {
+    int free_index = -1;
+    for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
+        if (active_alarms_[i] == alarm_id) {
+            if (clear_deadlines_[i] != 0) {
+                LOG_DBG("[alarm] Alarm ID 0x%X raised within hold-off, clear cancelled", alarm_id);
+                clear_deadlines_[i] = 0;
+            }
+            if (alarm_states_[i] == kAlarmStateLatched) {
+                // Still shown, so only the condition is recorded
+                LOG_ERR("[alarm] Latched alarm ID 0x%X raised again", alarm_id);
+                alarm_states_[i] = kAlarmStateActive;
+                publish_snapshot();
+                record_condition(true, alarm_id, epoch, now);
+            }
+            return 0;
+        }
+        if (active_alarms_[i] == 0 && free_index < 0) {
+            free_index = i;
+        }
+    }
+
+    if (free_index < 0) {
+        return -1;
+    }
+
+    LOG_ERR("[alarm] Setting alarm ID 0x%X", alarm_id);
+    active_alarms_[free_index] = alarm_id;
+    active_alarm_times_[free_index] = epoch;
+    clear_deadlines_[free_index] = 0;
+    alarm_states_[free_index] = kAlarmStateActive;
+    link_slot(free_index);
+
+    *publish |= record_change(true, alarm_id, epoch, now);
+    // A critical alarm is never held back by the notification window
+    *publish |= AlarmGetType(alarm_id) == 'A';
+    return 0;
+}
+
+/**
+ * Clear the alarm in a slot, or start its hold-off. Must be called with alarm_mutex_ held.
+ */
+static void clear_alarm_at(const int index, const int64_t now, const uint32_t epoch, bool *publish) {
+    if (clear_deadlines_[index] != 0 || alarm_states_[index] == kAlarmStateLatched) {
+        return;
+    }
+
+    const uint16_t hold_off_ms = get_hold_off(active_alarms_[index]);
+    if (hold_off_ms > 0) {
+        // Keep the alarm active until the condition has been gone for the whole hold-off
+        clear_deadlines_[index] = now + hold_off_ms;
+        schedule_clear_work(now);
+    } else {
+        *publish |= remove_alarm(index, now, epoch);
+    }
+}
+
+/**
+ * Clear an alarm, or start its hold-off. Must be called with alarm_mutex_ held.
+ */
+static int clear_alarm(const uint16_t alarm_id, const int64_t now, const uint32_t epoch, bool *publish) {
+    for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
+        if (active_alarms_[i] == alarm_id) {
+            clear_alarm_at(i, now, epoch, publish);
+            return 0;
+        }
+    }
+    return -1;
+}
+
 void AlarmInit() {
     k_mutex_init(&alarm_mutex_);
     memset(active_alarms_, 0, sizeof(active_alarms_));
     memset(active_alarm_times_, 0, sizeof(active_alarm_times_));
+    memset(clear_deadlines_, 0, sizeof(clear_deadlines_));
+    memset(alarm_states_, 0, sizeof(alarm_states_));
+    memset(error_origins_, 0, sizeof(error_origins_));
+    memset(origin_counts_, 0, sizeof(origin_counts_));
+    for (int i = 0; i < kAlarmNumLists; ++i) {
+        alarm_lists_[i].head = ALARM_NO_SLOT;
+        alarm_lists_[i].tail = ALARM_NO_SLOT;
+    }
+    memset(snapshots_, 0, sizeof(snapshots_));
+    atomic_set(&snapshot_generation_, 0);
+    memset(hold_offs_, 0, sizeof(hold_offs_));
+    alarm_stats_clear();
+    n_pending_ = 0;
+    pending_epoch_ = 0;
+    notify_window_ms_ = ALARM_DEFAULT_NOTIFY_WINDOW_MS;
+    k_work_init_delayable(&clear_work_, clear_work_handler);
+    k_work_init_delayable(&notify_work_, notify_work_handler);
+}
+
+int AlarmSetHoldOff(const uint16_t alarm_id, const uint16_t hold_off_ms) {
+    int rc = -ENOMEM;
+    if (alarm_id == 0) {
+        return -EINVAL;
+    }
+
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        int free_index = -1;
+        for (int i = 0; i < ALARM_MAX_HOLD_OFFS; ++i) {
+            if (hold_offs_[i].alarm_id == alarm_id) {
+                free_index = i;
+                break;
+            }
+            if (hold_offs_[i].alarm_id == 0 && free_index < 0) {
+                free_index = i;
+            }
+        }
+
+        if (free_index >= 0) {
+            hold_offs_[free_index].alarm_id = alarm_id;
+            hold_offs_[free_index].hold_off_ms = hold_off_ms;
+            rc = 0;
+        }
+        k_mutex_unlock(&alarm_mutex_);
+    }
+    return rc;
+}
+
+void AlarmSetNotifyWindow(const uint16_t window_ms) {
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        notify_window_ms_ = window_ms;
+        k_mutex_unlock(&alarm_mutex_);
+    }
 }
 
 char AlarmGetType(uint16_t alarm_id) {
@@ -57,104 +568,223 @@ char AlarmGetType(uint16_t alarm_id) {
     return 'U';
 }
 
-static void notify_alarm(const bool active, const uint16_t alarm_id, const uint32_t epoch) {
-    struct kzbus_msg_t alarm_msg;
-    alarm_msg.msg_type = kMsgAlarm;
-    alarm_msg.epoch_time = epoch;
-    alarm_msg.alarm_msg.alarm_active = active;
-    alarm_msg.alarm_msg.alarm_id = alarm_id;
-    zbus_chan_pub(&kzbus_alarm_chan, &alarm_msg, K_NO_WAIT);
-}
-
 int AlarmSet(const bool active, const uint8_t error_id, const alarm_origin_t origin) {
     const uint16_t alarm_id = (((uint16_t)error_id) & ALARM_ERROR_ID_MASK) | (origin & ALARM_ORIGIN_MASK);
     int rc = -1;
-    uint32_t first_free_index = UINT32_MAX;
-    bool notify = false;
+    bool publish = false;
+    // Read before locking, the RTC is a driver call
+    const uint32_t epoch = RtcGetEpoch();
+
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        const int64_t now = k_uptime_get();
+        if (active) {
+            rc = raise_alarm(alarm_id, now, epoch, &publish);
+        } else {
+            rc = clear_alarm(alarm_id, now, epoch, &publish);
+        }
+        k_mutex_unlock(&alarm_mutex_);
+    }
+
+    if (publish) {
+        publish_notifications();
+    }
+
+    return rc;
+}
 
+int AlarmSetMask(const alarm_origin_t origin, const uint8_t *active_bitmap) {
+    if (active_bitmap == NULL) {
+        return -EINVAL;
+    }
+
+    const uint16_t origin_bits = origin & ALARM_ORIGIN_MASK;
+    int rc = 0;
+    bool publish = false;
+    // Read once before locking, rather than for every raised or cleared alarm
     const uint32_t epoch = RtcGetEpoch();
 
     if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        const int64_t now = k_uptime_get();
+        uint8_t current_bitmap[ALARM_ERROR_BITMAP_SIZE] = {0};
+
+        // Clear alarms from this origin that are no longer reported
         for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
-            const uint16_t alarm_id_i = active_alarms_[i];
-            if (alarm_id_i == 0 && first_free_index == UINT32_MAX) {
-                first_free_index = i;
+            const uint16_t alarm_id = active_alarms_[i];
+            if (alarm_id == 0 || (alarm_id & ALARM_ORIGIN_MASK) != origin_bits ||
+                alarm_states_[i] == kAlarmStateLatched) {
+                // Latched alarms are raised again below if reported
+                continue;
             }
-            if (alarm_id_i == alarm_id) {
-                if (!active) {
-                    LOG_INF("[alarm] Clearing alarm ID 0x%X", alarm_id);
-                    active_alarms_[i] = 0;
-                    active_alarm_times_[i] = 0;
-                    notify = true;
-                    rc = 0;
-                    break;
-                }
+
+            const uint8_t error_id = alarm_id & ALARM_ERROR_ID_MASK;
+            const uint8_t bit = 1 << (error_id % 8);
+            current_bitmap[error_id / 8] |= bit;
+            if (active_bitmap[error_id / 8] & bit) {
+                // Still reported, cancel a held-off clear
+                clear_deadlines_[i] = 0;
+            } else {
+                clear_alarm_at(i, now, epoch, &publish);
             }
         }
 
-        if (first_free_index < ALARM_MAX_ALARMS && active) {
-            LOG_ERR("[alarm] Setting alarm ID 0x%X", alarm_id);
-            active_alarms_[first_free_index] = alarm_id;
-            active_alarm_times_[first_free_index] = epoch;
-            notify = true;
-            rc = 0;
+        // Raise newly reported alarms
+        for (int byte = 0; byte < ALARM_ERROR_BITMAP_SIZE; ++byte) {
+            uint8_t raised = active_bitmap[byte] & ~current_bitmap[byte];
+            for (int bit = 0; raised != 0; ++bit, raised >>= 1) {
+                if ((raised & 1) && raise_alarm((byte * 8 + bit) | origin_bits, now, epoch, &publish) != 0) {
+                    rc = -1;
+                }
+            }
         }
 
         k_mutex_unlock(&alarm_mutex_);
     }
 
-    if (notify) {
-        notify_alarm(active, alarm_id, epoch);
+    // All changes were queued under one lock, so they go out together
+    if (publish) {
+        publish_notifications();
     }
 
     return rc;
 }
 
-bool AlarmActiveTypeAAlarms() {
-    bool ret = false;
+int AlarmAcknowledge(const uint16_t alarm_id) {
+    int rc = -ENOENT;
+    bool publish = false;
+    const uint32_t epoch = RtcGetEpoch();
+
     if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
         for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
-            if (AlarmGetType(active_alarms_[i]) == 'A') {
-                ret = true;
+            if (active_alarms_[i] == alarm_id) {
+                if (acknowledge_at(i, epoch, &publish)) {
+                    publish_snapshot();
+                }
+                rc = 0;
                 break;
             }
         }
         k_mutex_unlock(&alarm_mutex_);
     }
-    return ret;
+
+    if (publish) {
+        publish_notifications();
+    }
+
+    return rc;
 }
 
-int AlarmWalk(alarm_walk_cb_t cb, void *arg) {
-    int rc = 0;
+int AlarmAcknowledgeAll() {
+    int n_acknowledged = 0;
+    bool publish = false;
+    const uint32_t epoch = RtcGetEpoch();
+
     if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
-        for (int i = 0; i < ALARM_MAX_ALARMS && rc == 0; ++i) {
-            struct alarm_t alarm;
-            alarm.id = active_alarms_[i];
-            if (alarm.id == 0) {
-                continue;
+        for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
+            if (active_alarms_[i] != 0 && acknowledge_at(i, epoch, &publish)) {
+                ++n_acknowledged;
             }
-            alarm.epoch = active_alarm_times_[i];
-
-            rc = cb(alarm, arg);
+        }
+        if (n_acknowledged > 0) {
+            publish_snapshot();
         }
         k_mutex_unlock(&alarm_mutex_);
     }
+
+    if (publish) {
+        publish_notifications();
+    }
+
+    return n_acknowledged;
+}
+
+int AlarmSnapshot(struct alarm_snapshot *snapshot) {
+    if (snapshot == NULL) {
+        return -EINVAL;
+    }
+
+    atomic_val_t generation;
+    do {
+        generation = atomic_get(&snapshot_generation_);
+        memcpy(snapshot, &snapshots_[generation & 1], sizeof(*snapshot));
+        barrier_dmem_fence_full();
+    } while (atomic_get(&snapshot_generation_) != generation);
+
+    return 0;
+}
+
+int AlarmGetTopActive(struct alarm_t *alarm) {
+    if (alarm == NULL) {
+        return -EINVAL;
+    }
+
+    // Same retry as AlarmSnapshot(), but only the top entry is copied
+    atomic_val_t generation;
+    do {
+        generation = atomic_get(&snapshot_generation_);
+        *alarm = snapshots_[generation & 1].top;
+        barrier_dmem_fence_full();
+    } while (atomic_get(&snapshot_generation_) != generation);
+
+    return alarm->id != 0 ? 0 : -ENOENT;
+}
+
+bool AlarmActiveTypeAAlarms() {
+    struct alarm_t top;
+    // Type A alarms are always on top if there are any
+    return AlarmGetTopActive(&top) == 0 && AlarmGetType(top.id) == 'A';
+}
+
+int AlarmWalk(alarm_walk_cb_t cb, void *arg) { return AlarmWalkState(ALARM_STATE_CONDITION_ACTIVE, cb, arg); }
+
+int AlarmWalkState(const uint8_t state_mask, alarm_walk_cb_t cb, void *arg) {
+    struct alarm_snapshot snapshot;
+    AlarmSnapshot(&snapshot);
+
+    int rc = 0;
+    for (int i = 0; i < snapshot.n_alarms && rc == 0; ++i) {
+        if (snapshot.alarms[i].state & state_mask) {
+            rc = cb(snapshot.alarms[i], arg);
+        }
+    }
     return rc;
 }
 
 bool AlarmIsActive(const uint8_t error_id, alarm_origin_t *origin) {
-    bool is_active = false;
-    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
-        for (int i = 0; i < ALARM_MAX_ALARMS; ++i) {
-            if ((active_alarms_[i] & ALARM_ERROR_ID_MASK) == error_id) {
-                is_active = true;
-                if (origin != NULL) {
-                    *origin = active_alarms_[i] & ALARM_ORIGIN_MASK;
-                }
-                break;
+    struct alarm_snapshot snapshot;
+    AlarmSnapshot(&snapshot);
+
+    for (int i = 0; i < snapshot.n_alarms; ++i) {
+        if ((snapshot.alarms[i].id & ALARM_ERROR_ID_MASK) == error_id &&
+            (snapshot.alarms[i].state & ALARM_STATE_CONDITION_ACTIVE)) {
+            if (origin != NULL) {
+                *origin = snapshot.alarms[i].id & ALARM_ORIGIN_MASK;
             }
+            return true;
         }
+    }
+    return false;
+}
+
+uint8_t AlarmOriginBit(const alarm_origin_t origin) { return 1 << get_origin_index(origin); }
+
+bool AlarmIsActiveFrom(const alarm_origin_t origin, const uint8_t error_id) {
+    return (AlarmOriginsWithError(error_id) & AlarmOriginBit(origin)) != 0;
+}
+
+uint8_t AlarmOriginsWithError(const uint8_t error_id) {
+    uint8_t origins = 0;
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        origins = error_origins_[error_id];
+        k_mutex_unlock(&alarm_mutex_);
+    }
+    return origins;
+}
+
+uint8_t AlarmCountByOrigin(const alarm_origin_t origin) {
+    uint8_t count = 0;
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        count = origin_counts_[get_origin_index(origin)];
         k_mutex_unlock(&alarm_mutex_);
     }
-    return is_active;
+    return count;
 }
@@ -0,0 +1,283 @@
+#include "koster-common/alarm_journal.h"
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "circular_log.h"
+
+LOG_MODULE_DECLARE(koster_common);
+
+#if DT_HAS_CHOSEN(koster_alarm_journal_partition)
+#define JOURNAL_PARTITION DT_FIXED_PARTITION_ID(DT_CHOSEN(koster_alarm_journal_partition))
+#else
+#define JOURNAL_PARTITION FIXED_PARTITION_ID(alarm_journal_partition)
+#endif
+
+#define JOURNAL_BATCH_EVENTS CONFIG_KOSTER_COMMON_ALARM_JOURNAL_BATCH_EVENTS
+#define JOURNAL_FLUSH_INTERVAL K_SECONDS(CONFIG_KOSTER_COMMON_ALARM_JOURNAL_FLUSH_INTERVAL_S)
+// Number of events read at a time when querying
+#define JOURNAL_QUERY_CHUNK 16
+
+// Written to flash in front of the events of each batch
+struct journal_batch_header {
+    uint32_t first_epoch;
+    uint32_t last_epoch;
+    uint16_t n_events;
+    uint16_t n_dropped;  // events lost before this batch because the buffer was full
+};
+
+// The RAM buffer has the same layout as a batch in flash, so a flush is a single log entry write
+static struct {
+    struct journal_batch_header header;
+    struct alarm_journal_event_t events[JOURNAL_BATCH_EVENTS];
+} batch_;
+
+static struct k_mutex journal_mutex_;  // protects batch_.events, n_buffered_ and n_dropped_
+static struct k_mutex flush_mutex_;    // serializes flushes and queries
+static uint16_t n_buffered_;
+static uint16_t n_dropped_;
+static bool initialized_;
+
+static struct circular_log clog_;
+static bool clog_ready_;
+
+static struct k_work flush_work_;
+static struct k_work_delayable periodic_flush_work_;
+
+struct query_ctx {
+    uint32_t from_epoch;
+    uint32_t to_epoch;
+    uint16_t alarm_id;
+    alarm_journal_cb_t cb;
+    void *arg;
+    int n_reported;
+    bool stop;
+};
+
+static void flush_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    AlarmJournalFlush();
+}
+
+static void periodic_flush_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    AlarmJournalFlush();
+    k_work_reschedule(&periodic_flush_work_, JOURNAL_FLUSH_INTERVAL);
+}
+
+int AlarmJournalInit() {
+    k_mutex_init(&journal_mutex_);
+    k_mutex_init(&flush_mutex_);
+    memset(&batch_, 0, sizeof(batch_));
+    n_buffered_ = 0;
+    n_dropped_ = 0;
+    k_work_init(&flush_work_, flush_work_handler);
+    k_work_init_delayable(&periodic_flush_work_, periodic_flush_work_handler);
+    initialized_ = true;
+
+    // Even if the partition is unusable, events are still buffered and can be queried from RAM
+    int rc = circular_log_init(&clog_, JOURNAL_PARTITION, sizeof(batch_), true);
+    if (rc != 0) {
+        LOG_ERR("[alarm journal] Failed to open journal partition (%d)", rc);
+        return rc;
+    }
+    clog_ready_ = true;
+
+    k_work_schedule(&periodic_flush_work_, JOURNAL_FLUSH_INTERVAL);
+
+    return 0;
+}
+
+int AlarmJournalRecord(const bool active, const uint16_t alarm_id, const uint32_t epoch) {
+    if (!initialized_) {
+        return -ENODEV;
+    }
+
+    int rc = -ENOMEM;
+    bool full = false;
+    if (k_mutex_lock(&journal_mutex_, K_FOREVER) == 0) {
+        if (n_buffered_ < JOURNAL_BATCH_EVENTS) {
+            struct alarm_journal_event_t *event = &batch_.events[n_buffered_];
+            event->epoch = epoch;
+            event->alarm_id = alarm_id;
+            event->active = active ? 1 : 0;
+            event->reserved = 0;
+            ++n_buffered_;
+            rc = 0;
+        } else if (n_dropped_ < UINT16_MAX) {
+            ++n_dropped_;
+        }
+        full = n_buffered_ == JOURNAL_BATCH_EVENTS;
+        k_mutex_unlock(&journal_mutex_);
+    }
+
+    if (full) {
+        k_work_submit(&flush_work_);
+    }
+
+    return rc;
+}
+
+int AlarmJournalFlush() {
+    if (!clog_ready_) {
+        return -ENODEV;
+    }
+
+    if (k_mutex_lock(&flush_mutex_, K_FOREVER) != 0) {
+        return -EBUSY;
+    }
+
+    uint16_t n_events = 0;
+    uint16_t n_dropped = 0;
+    if (k_mutex_lock(&journal_mutex_, K_FOREVER) == 0) {
+        n_events = n_buffered_;
+        n_dropped = n_dropped_;
+        n_dropped_ = 0;
+        k_mutex_unlock(&journal_mutex_);
+    }
+
+    int rc = 0;
+    if (n_events > 0) {
+        // Events [0, n_events) are stable here: AlarmJournalRecord() only appends after them, and only
+        // flushes move them.
+        batch_.header.n_events = n_events;
+        batch_.header.n_dropped = n_dropped;
+        batch_.header.first_epoch = UINT32_MAX;
+        batch_.header.last_epoch = 0;
+        for (uint16_t i = 0; i < n_events; ++i) {
+            batch_.header.first_epoch = MIN(batch_.header.first_epoch, batch_.events[i].epoch);
+            batch_.header.last_epoch = MAX(batch_.header.last_epoch, batch_.events[i].epoch);
+        }
+
+        rc = circular_log_write(&clog_,
+                                &batch_,
+                                sizeof(struct journal_batch_header) + n_events * sizeof(struct alarm_journal_event_t));
+
+        if (k_mutex_lock(&journal_mutex_, K_FOREVER) == 0) {
+            if (rc == 0) {
+                memmove(batch_.events,
+                        &batch_.events[n_events],
+                        (n_buffered_ - n_events) * sizeof(struct alarm_journal_event_t));
+                n_buffered_ -= n_events;
+            } else {
+                LOG_ERR("[alarm journal] Failed to write batch of %u events (%d)", n_events, rc);
+                n_dropped_ += n_dropped;
+            }
+            k_mutex_unlock(&journal_mutex_);
+        }
+    }
+
+    k_mutex_unlock(&flush_mutex_);
+    return rc;
+}
+
+static bool report_event(struct query_ctx *ctx, const struct alarm_journal_event_t *event) {
+    if (event->epoch < ctx->from_epoch || event->epoch > ctx->to_epoch) {
+        return false;
+    }
+    if (ctx->alarm_id != 0 && event->alarm_id != ctx->alarm_id) {
+        return false;
+    }
+
+    ++ctx->n_reported;
+    if (ctx->cb != NULL && ctx->cb(event, ctx->arg) != 0) {
+        ctx->stop = true;
+    }
+    return ctx->stop;
+}
+
+static int query_batch(const struct circular_log_entry *entry, void *arg) {
+    struct query_ctx *ctx = (struct query_ctx *)arg;
+    struct journal_batch_header header;
+
+    if (circular_log_read(entry, 0, &header, sizeof(header)) != sizeof(header)) {
+        return 0;
+    }
+
+    // Skip batches whose header does not match the entry, e.g. left behind by an older layout
+    if (header.n_events > JOURNAL_BATCH_EVENTS ||
+        (size_t)entry->data_length != sizeof(header) + header.n_events * sizeof(struct alarm_journal_event_t)) {
+        return 0;
+    }
+
+    // Skip the whole batch without reading its events if it is outside the time range
+    if (header.last_epoch < ctx->from_epoch || header.first_epoch > ctx->to_epoch) {
+        return 0;
+    }
+
+    struct alarm_journal_event_t events[JOURNAL_QUERY_CHUNK];
+    for (uint16_t i = 0; i < header.n_events; i += JOURNAL_QUERY_CHUNK) {
+        const uint16_t n_chunk = MIN(JOURNAL_QUERY_CHUNK, header.n_events - i);
+        const off_t offset = sizeof(header) + i * sizeof(struct alarm_journal_event_t);
+        const int rc = circular_log_read(entry, offset, events, n_chunk * sizeof(struct alarm_journal_event_t));
+        if (rc < 0) {
+            return rc;
+        }
+
+        for (uint16_t j = 0; j < rc / sizeof(struct alarm_journal_event_t); ++j) {
+            if (report_event(ctx, &events[j])) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int AlarmJournalQuery(const uint32_t from_epoch,
+                      const uint32_t to_epoch,
+                      const uint16_t alarm_id,
+                      alarm_journal_cb_t cb,
+                      void *arg) {
+    if (!initialized_) {
+        return -ENODEV;
+    }
+
+    struct query_ctx ctx = {
+            .from_epoch = from_epoch,
+            .to_epoch = to_epoch,
+            .alarm_id = alarm_id,
+            .cb = cb,
+            .arg = arg,
+            .n_reported = 0,
+            .stop = false,
+    };
+
+    // Holding flush_mutex_ keeps the buffered events in place while they are reported. AlarmSet() only needs
+    // journal_mutex_, which is never held while calling cb.
+    if (k_mutex_lock(&flush_mutex_, K_FOREVER) != 0) {
+        return -EBUSY;
+    }
+
+    if (clog_ready_) {
+        circular_log_emit(&clog_, query_batch, &ctx);
+    }
+
+    struct alarm_journal_event_t events[JOURNAL_QUERY_CHUNK];
+    for (uint16_t i = 0; !ctx.stop; i += JOURNAL_QUERY_CHUNK) {
+        uint16_t n_chunk = 0;
+        if (k_mutex_lock(&journal_mutex_, K_FOREVER) == 0) {
+            if (i < n_buffered_) {
+                n_chunk = MIN(JOURNAL_QUERY_CHUNK, n_buffered_ - i);
+                memcpy(events, &batch_.events[i], n_chunk * sizeof(struct alarm_journal_event_t));
+            }
+            k_mutex_unlock(&journal_mutex_);
+        }
+
+        if (n_chunk == 0) {
+            break;
+        }
+
+        for (uint16_t j = 0; j < n_chunk; ++j) {
+            if (report_event(&ctx, &events[j])) {
+                break;
+            }
+        }
+    }
+
+    k_mutex_unlock(&flush_mutex_);
+    return ctx.n_reported;
+}
@@ -0,0 +1,25 @@
+#ifndef KOSTER_COMMON_ALARM_PRIVATE_H
+#define KOSTER_COMMON_ALARM_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+// Protects the active set and everything updated along with it, including the alarm statistics
+extern struct k_mutex alarm_mutex_;
+
+/**
+ * Clear all alarm statistics. Called by AlarmInit().
+ */
+void alarm_stats_clear();
+
+/**
+ * Update the statistics of an alarm that was raised or cleared. Must be called with alarm_mutex_ held.
+ *
+ * @param active    true if the alarm was raised, false if it was cleared
+ * @param alarm_id  the alarm ID (origin | error_id)
+ * @param now       uptime (ms) of the change
+ */
+void alarm_stats_record(const bool active, const uint16_t alarm_id, const int64_t now);
+
+#endif
@@ -0,0 +1,304 @@
+#include "koster-common/alarm_stats.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+
+#include "alarm_private.h"
+
+LOG_MODULE_DECLARE(koster_common);
+
+#define ALARM_STATS_SETTING "alarm/stats"
+
+#if defined(CONFIG_KOSTER_COMMON_ALARM_STATS_PERSIST_INTERVAL_S)
+#define ALARM_STATS_PERSIST_INTERVAL_S CONFIG_KOSTER_COMMON_ALARM_STATS_PERSIST_INTERVAL_S
+#else
+#define ALARM_STATS_PERSIST_INTERVAL_S 3600
+#endif
+
+struct alarm_stats_entry {
+    struct alarm_stats_t stats;
+    bool active;
+    int64_t active_since;  // uptime (ms) of the current activation, valid while active
+};
+
+// Open addressing hash table keyed by alarm ID, alarm_id 0 marks a free slot. Entries are only removed all
+// at once by alarm_stats_clear(). Protected by alarm_mutex_.
+static struct alarm_stats_entry entries_[ALARM_STATS_MAX_ALARMS];
+static bool dirty_;   // changed since the last persist
+static bool loaded_;  // the stored statistics have been added, ignore later settings_load() calls
+static bool full_warned_;
+
+static struct settings_handler handler_;
+static struct k_work_delayable persist_work_;
+
+// Serializes use of persist_buffer_
+static struct k_mutex persist_mutex_;
+static struct alarm_stats_t persist_buffer_[ALARM_STATS_MAX_ALARMS];
+
+static uint32_t hash_alarm_id(const uint16_t alarm_id) {
+    // Spread the origin (high byte) so that equal error IDs of different origins do not collide
+    return (alarm_id ^ (alarm_id >> 8) * 7u) & (ALARM_STATS_MAX_ALARMS - 1);
+}
+
+/**
+ * Find the entry of an alarm. Must be called with alarm_mutex_ held.
+ *
+ * @param create  claim a free slot if the alarm has no entry yet
+ * @return the entry, or NULL if there is none (or the table is full)
+ */
+static struct alarm_stats_entry *find_entry(const uint16_t alarm_id, const bool create) {
+    uint32_t index = hash_alarm_id(alarm_id);
+
+    for (int probe = 0; probe < ALARM_STATS_MAX_ALARMS; ++probe) {
+        struct alarm_stats_entry *entry = &entries_[index];
+        if (entry->stats.alarm_id == alarm_id) {
+            return entry;
+        }
+        if (entry->stats.alarm_id == 0) {
+            if (!create) {
+                return NULL;
+            }
+            entry->stats.alarm_id = alarm_id;
+            return entry;
+        }
+        index = (index + 1) & (ALARM_STATS_MAX_ALARMS - 1);
+    }
+
+    if (create && !full_warned_) {
+        LOG_WRN("[alarm] Statistics table full, not counting alarm ID 0x%X", alarm_id);
+        full_warned_ = true;
+    }
+    return NULL;
+}
+
+/**
+ * @return true if the entry has anything to report (AlarmStatsReset() leaves entries of unraised alarms)
+ */
+static bool entry_used(const struct alarm_stats_entry *entry) {
+    return entry->stats.alarm_id != 0 && (entry->stats.count != 0 || entry->active);
+}
+
+/**
+ * Copy the statistics of an entry, including the time of the current activation. Must be called with
+ * alarm_mutex_ held.
+ */
+static void copy_stats(const struct alarm_stats_entry *entry, const int64_t now, struct alarm_stats_t *stats) {
+    *stats = entry->stats;
+    if (entry->active && now > entry->active_since) {
+        stats->active_ms += (uint64_t)(now - entry->active_since);
+    }
+}
+
+void alarm_stats_clear() {
+    memset(entries_, 0, sizeof(entries_));
+    dirty_ = false;
+    loaded_ = false;
+    full_warned_ = false;
+}
+
+void alarm_stats_record(const bool active, const uint16_t alarm_id, const int64_t now) {
+    struct alarm_stats_entry *entry = find_entry(alarm_id, active);
+    if (entry == NULL) {
+        return;
+    }
+
+    if (active) {
+        ++entry->stats.count;
+        entry->active = true;
+        entry->active_since = now;
+    } else if (entry->active) {
+        copy_stats(entry, now, &entry->stats);
+        entry->active = false;
+    }
+    dirty_ = true;
+}
+
+/**
+ * Copy all statistics into persist_buffer_. Must be called with persist_mutex_ held.
+ *
+ * @return the number of entries copied
+ */
+static int pack_stats() {
+    int n_stats = 0;
+
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        const int64_t now = k_uptime_get();
+        for (int i = 0; i < ALARM_STATS_MAX_ALARMS; ++i) {
+            if (entry_used(&entries_[i])) {
+                copy_stats(&entries_[i], now, &persist_buffer_[n_stats]);
+                ++n_stats;
+            }
+        }
+        dirty_ = false;
+        k_mutex_unlock(&alarm_mutex_);
+    }
+
+    return n_stats;
+}
+
+static int handle_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
+    const char *next;
+    size_t name_len;
+
+    name_len = settings_name_next(name, &next);
+
+    if (name_len == sizeof("stats") - 1 && !strncmp(name, "stats", name_len)) {
+        if (len % sizeof(struct alarm_stats_t) != 0 || len > sizeof(persist_buffer_)) {
+            LOG_ERR("[alarm] handle_set: unexpected size of alarm statistics");
+            return -EINVAL;
+        }
+
+        int rc = -EBUSY;
+        if (k_mutex_lock(&persist_mutex_, K_FOREVER) == 0) {
+            rc = read_cb(cb_arg, persist_buffer_, len);
+            if (rc >= 0 && k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+                // Add to what has been counted since boot
+                for (size_t i = 0; !loaded_ && i < len / sizeof(struct alarm_stats_t); ++i) {
+                    struct alarm_stats_entry *entry = find_entry(persist_buffer_[i].alarm_id, true);
+                    if (entry != NULL) {
+                        entry->stats.count += persist_buffer_[i].count;
+                        entry->stats.active_ms += persist_buffer_[i].active_ms;
+                    }
+                }
+                k_mutex_unlock(&alarm_mutex_);
+            }
+            k_mutex_unlock(&persist_mutex_);
+        }
+
+        return rc >= 0 ? 0 : rc;
+    }
+
+    return -ENOENT;
+}
+
+static int handle_export(int (*storage_func)(const char *name, const void *value, size_t val_len)) {
+    int ret = -EBUSY;
+    if (k_mutex_lock(&persist_mutex_, K_FOREVER) == 0) {
+        const int n_stats = pack_stats();
+        ret = storage_func(ALARM_STATS_SETTING, persist_buffer_, n_stats * sizeof(struct alarm_stats_t));
+        k_mutex_unlock(&persist_mutex_);
+    }
+    return ret;
+}
+
+static void persist_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    bool dirty = false;
+
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        dirty = dirty_;
+        k_mutex_unlock(&alarm_mutex_);
+    }
+
+    if (dirty) {
+        AlarmStatsPersist();
+    }
+    k_work_schedule(&persist_work_, K_SECONDS(ALARM_STATS_PERSIST_INTERVAL_S));
+}
+
+int AlarmStatsInit() {
+    k_mutex_init(&persist_mutex_);
+
+    handler_.name = "alarm";
+    handler_.h_get = NULL;
+    handler_.h_set = handle_set;
+    handler_.h_commit = NULL;
+    handler_.h_export = handle_export;
+
+    int rc = settings_register(&handler_);
+    if (rc != 0) {
+        LOG_ERR("[alarm] settings_register failed (err %d)", rc);
+        return -1;
+    }
+
+    rc = settings_load_subtree(handler_.name);
+    if (rc != 0) {
+        LOG_ERR("[alarm] settings_load_subtree failed (err %d)", rc);
+        return -1;
+    }
+
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        // The stored statistics are added once, ignore them when the application calls settings_load()
+        loaded_ = true;
+        k_mutex_unlock(&alarm_mutex_);
+    }
+
+    k_work_init_delayable(&persist_work_, persist_work_handler);
+    k_work_schedule(&persist_work_, K_SECONDS(ALARM_STATS_PERSIST_INTERVAL_S));
+
+    return 0;
+}
+
+int AlarmStatsGet(const uint16_t alarm_id, struct alarm_stats_t *stats) {
+    int rc = -ENOENT;
+    if (alarm_id == 0 || stats == NULL) {
+        return -EINVAL;
+    }
+
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        const struct alarm_stats_entry *entry = find_entry(alarm_id, false);
+        if (entry != NULL && entry_used(entry)) {
+            copy_stats(entry, k_uptime_get(), stats);
+            rc = 0;
+        }
+        k_mutex_unlock(&alarm_mutex_);
+    }
+
+    return rc;
+}
+
+int AlarmStatsWalk(alarm_stats_cb_t cb, void *arg) {
+    int n_reported = 0;
+
+    for (int i = 0; i < ALARM_STATS_MAX_ALARMS; ++i) {
+        struct alarm_stats_t stats = {0};
+        if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+            if (entry_used(&entries_[i])) {
+                copy_stats(&entries_[i], k_uptime_get(), &stats);
+            }
+            k_mutex_unlock(&alarm_mutex_);
+        }
+
+        if (stats.alarm_id == 0) {
+            continue;
+        }
+        ++n_reported;
+        if (cb(&stats, arg) != 0) {
+            break;
+        }
+    }
+
+    return n_reported;
+}
+
+int AlarmStatsPersist() {
+    int rc = -EBUSY;
+
+    if (k_mutex_lock(&persist_mutex_, K_FOREVER) == 0) {
+        const int n_stats = pack_stats();
+        rc = settings_save_one(ALARM_STATS_SETTING, persist_buffer_, n_stats * sizeof(struct alarm_stats_t));
+        if (rc != 0) {
+            LOG_ERR("[alarm] settings_save_one failed (err %d)", rc);
+        }
+        k_mutex_unlock(&persist_mutex_);
+    }
+
+    return rc;
+}
+
+int AlarmStatsReset() {
+    if (k_mutex_lock(&alarm_mutex_, K_FOREVER) == 0) {
+        // Keep the alarm IDs in place, removing them would break the probe sequences of other entries
+        const int64_t now = k_uptime_get();
+        for (int i = 0; i < ALARM_STATS_MAX_ALARMS; ++i) {
+            entries_[i].stats.count = 0;
+            entries_[i].stats.active_ms = 0;
+            entries_[i].active_since = now;
+        }
+        k_mutex_unlock(&alarm_mutex_);
+    }
+
+    return AlarmStatsPersist();
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2025 Hedson Technologies AB
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "circular_log.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+
+#define LOG_MAGIC 0xAFFECAFE
+
+LOG_MODULE_DECLARE(koster_common);
+
+// Written to flash as a header for each log entry
+struct log_entry_header {
+    uint32_t magic;
+    uint16_t sequence;
+    uint16_t length;
+};
+
+static bool read_header(const struct circular_log *clog, uint32_t index, struct log_entry_header *hdr) {
+    off_t offset = index * clog->aligned_entry_size;
+    return flash_area_read(clog->fap, offset, hdr, sizeof(*hdr)) == 0 && hdr->magic == LOG_MAGIC;
+}
+
+// The newest entry is the last of a run of consecutive sequence numbers, compared modulo 2^16 so that the
+// head survives the sequence wrapping around. A corrupt entry splits the log into several runs, then the
+// run end with the newest sequence wins.
+static int scan_entries(struct circular_log *clog) {
+    struct log_entry_header first, prev, hdr;
+    bool found = false;
+    uint16_t newest = 0;
+
+    clog->next_sequence = 0;
+    clog->head = 0;
+
+    const bool first_valid = read_header(clog, 0, &first);
+    bool prev_valid = first_valid;
+    prev = first;
+
+    for (uint32_t i = 1; i <= clog->max_entries; i++) {
+        bool valid;
+        if (i < clog->max_entries) {
+            valid = read_header(clog, i, &hdr);
+        } else {
+            valid = first_valid;
+            hdr = first;
+        }
+
+        if (prev_valid && !(valid && hdr.sequence == (uint16_t)(prev.sequence + 1))) {
+            if (!found || (int16_t)(prev.sequence - newest) > 0) {
+                newest = prev.sequence;
+                clog->head = i % clog->max_entries;
+                found = true;
+            }
+        }
+
+        prev = hdr;
+        prev_valid = valid;
+    }
+
+    if (found) {
+        clog->next_sequence = newest + 1;
+    }
+    return 0;
+}
+
+int circular_log_write(struct circular_log *clog, const void *data, size_t len) {
+    int rc;
+    if (len + sizeof(struct log_entry_header) > clog->aligned_entry_size) {
+        return -EINVAL;
+    }
+
+    off_t offset = clog->aligned_entry_size * clog->head;
+    rc = flash_area_erase(clog->fap, offset, clog->aligned_entry_size);
+    if (rc != 0) {
+        return rc;
+    }
+    struct log_entry_header hdr = {
+            .magic = LOG_MAGIC,
+            .sequence = clog->next_sequence++,
+            .length = len,
+    };
+    clog->head = (clog->head + 1) % clog->max_entries;
+
+    // Write the header last, so an entry cut short by a reset has no magic and is skipped
+    rc = flash_area_write(clog->fap, offset + sizeof(hdr), data, len);
+    if (rc != 0) {
+        return rc;
+    }
+    rc = flash_area_write(clog->fap, offset, &hdr, sizeof(hdr));
+    if (rc != 0) {
+        return rc;
+    }
+    return 0;
+}
+
+int circular_log_read(const struct circular_log_entry *entry, off_t offset, void *data, size_t len) {
+    if (!entry || !data || offset < 0) {
+        return -EINVAL;
+    }
+    if (offset >= entry->data_length) {
+        return 0;
+    }
+    size_t read_len = MIN(len, (size_t)(entry->data_length - offset));
+    off_t data_offset = entry->offset + sizeof(struct log_entry_header) + offset;
+
+    int rc = flash_area_read(entry->fap, data_offset, data, read_len);
+    if (rc != 0) {
+        LOG_ERR("Failed to read log entry");
+        return rc;
+    }
+
+    return read_len;
+}
+
+int circular_log_emit(struct circular_log *clog, circular_log_cb_t cb, void *arg) {
+    int emitted = 0;
+    for (int i = 0; i < clog->max_entries; i++) {
+        int index = (clog->head + i) % clog->max_entries;
+        off_t offset = clog->aligned_entry_size * index;
+        struct log_entry_header hdr;
+        // Read header and check header for magic number
+        if (flash_area_read(clog->fap, offset, &hdr, sizeof(hdr)) != 0 || hdr.magic != LOG_MAGIC) {
+            continue;
+        }
+
+        struct circular_log_entry entry = {.fap = clog->fap, .offset = offset, .data_length = hdr.length};
+
+        if (cb && cb(&entry, arg) != 0) {
+            break;
+        }
+
+        emitted++;
+    }
+
+    return emitted;
+}
+
+int circular_log_init(struct circular_log *clog, uint8_t partition_id, size_t entry_size, bool sector_aligned) {
+    struct flash_sector flash_sector;
+    size_t entry_size_with_hdr = entry_size + sizeof(struct log_entry_header);
+    uint32_t cnt;
+
+    int rc = flash_area_open(partition_id, &clog->fap);
+    if (rc) {
+        LOG_ERR("Failed to open flash area");
+        return rc;
+    }
+
+    // Get information of the first sector and assume all sectors are the same size
+    cnt = 1;
+    rc = flash_area_get_sectors(partition_id, &cnt, &flash_sector);
+    if (rc != 0 && rc != -ENOMEM) {
+        LOG_ERR("Failed to get sector for log partition (%d)", rc);
+        return rc;
+    }
+
+    if (sector_aligned || entry_size_with_hdr > flash_sector.fs_size) {
+        // Align up to sector size
+        clog->aligned_entry_size = ROUND_UP(entry_size_with_hdr, flash_sector.fs_size);
+    } else {
+        clog->aligned_entry_size = ROUND_UP(entry_size_with_hdr, 4);  // ensure alignment
+    }
+
+    clog->max_entries = clog->fap->fa_size / clog->aligned_entry_size;
+
+    return scan_entries(clog);
+}
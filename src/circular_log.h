@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Hedson Technologies AB
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef KOSTER_COMMON_CIRCULAR_LOG_H
+#define KOSTER_COMMON_CIRCULAR_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+struct flash_area;
+
+// A circular log of fixed size entries in a flash partition
+struct circular_log {
+    const struct flash_area *fap;
+    uint32_t aligned_entry_size;
+    uint16_t max_entries;
+    uint16_t head;  // next write index
+    uint16_t next_sequence;
+};
+
+// Location of one entry in flash, handed to circular_log_emit() callbacks
+struct circular_log_entry {
+    const struct flash_area *fap;
+    off_t offset;
+    ssize_t data_length;
+};
+
+typedef int (*circular_log_cb_t)(const struct circular_log_entry *entry, void *arg);
+
+/**
+ * Open the partition and find the newest entry.
+ *
+ * @param clog             the log to initialize
+ * @param partition_id     the fixed partition holding the log
+ * @param entry_size       maximum payload size of an entry
+ * @param sector_aligned   if true, every entry is rounded up to whole flash sectors
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int circular_log_init(struct circular_log *clog, uint8_t partition_id, size_t entry_size, bool sector_aligned);
+
+/**
+ * Overwrite the oldest entry with data.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int circular_log_write(struct circular_log *clog, const void *data, size_t len);
+
+/**
+ * Call cb for every valid entry, oldest first. Iteration stops if cb returns non-zero.
+ *
+ * @return the number of entries processed
+ */
+int circular_log_emit(struct circular_log *clog, circular_log_cb_t cb, void *arg);
+
+/**
+ * Read up to len bytes of an entry payload, starting at offset.
+ *
+ * @return the number of bytes read, or negative error code on failure
+ */
+int circular_log_read(const struct circular_log_entry *entry, off_t offset, void *data, size_t len);
+
+#endif
@@ -59,3 +59,13 @@ ZBUS_CHAN_DEFINE(kzbus_control_chan, /* Name */
                  NULL,               /* User data */
                  ZBUS_OBSERVERS(),   /* Observers */
                  ZBUS_MSG_INIT(0));
+
+/**
+ * Channel for parameter changes (from parameters)
+ */
+ZBUS_CHAN_DEFINE(kzbus_param_chan,   /* Name */
+                 struct kzbus_msg_t, /* Message type */
+                 NULL,               /* Validator */
+                 NULL,               /* User data */
+                 ZBUS_OBSERVERS(),   /* Observers */
+                 ZBUS_MSG_INIT(0));
@@ -10,126 +10,233 @@
 
 struct k_mutex param_mutex;
 
-int ParamGetName(const struct param_t* param, char* buf) {
-    int rc = -1;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            strncpy(buf, param->name, PARAM_NAME_MAX_LEN);
-            rc = 0;
+// Odd while several values are being stored, see ParamReadBegin()
+static unsigned int update_seq_;
+
+void param_update_begin() {
+    __atomic_store_n(&update_seq_, update_seq_ + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void param_update_end() {
+    __atomic_store_n(&update_seq_, update_seq_ + 1, __ATOMIC_RELEASE);
+}
+
+unsigned int ParamReadBegin() {
+    unsigned int seq = __atomic_load_n(&update_seq_, __ATOMIC_ACQUIRE);
+    while (seq & 1) {
+        // Wait on the writer's lock rather than spinning, the writer may have a lower priority
+        if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
+            k_mutex_unlock(&param_mutex);
         }
-        k_mutex_unlock(&param_mutex);
+        seq = __atomic_load_n(&update_seq_, __ATOMIC_ACQUIRE);
     }
-    return rc;
+    return seq;
+}
+
+bool ParamReadRetry(const unsigned int seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&update_seq_, __ATOMIC_RELAXED) != seq;
+}
+
+int ParamGetName(const struct param_t* param, char* buf) {
+    if (param == NULL) {
+        return -1;
+    }
+    strncpy(buf, param_name(param), PARAM_NAME_MAX_LEN);
+    return 0;
+}
+
+const char* ParamNamePtr(const struct param_t* param) {
+    if (param == NULL) {
+        return "";
+    }
+    return param_name(param);
+}
+
+const char* ParamDescriptionPtr(const struct param_t* param) {
+    if (param == NULL) {
+        return "";
+    }
+    return param_description(param);
+}
+
+const char* ParamEnumLabelPtr(const struct param_t* param, const int32_t value) {
+    if (param == NULL || param->enum_info == NULL || value < 0 || value >= param->enum_info->n_labels) {
+        return NULL;
+    }
+    return param->enum_info->labels[value];
+}
+
+const char* ParamGetEnumOptions(const struct param_t* param) {
+    if (param == NULL || param->enum_info == NULL) {
+        return NULL;
+    }
+    return param->enum_info->options;
+}
+
+int ParamEnumValueToRow(const struct param_t* param, const int32_t value) {
+    if (ParamEnumLabelPtr(param, value) == NULL) {
+        return -1;
+    }
+    return param->enum_info->value_rows[value];
+}
+
+int ParamEnumRowToValue(const struct param_t* param, const unsigned int row, int32_t* value) {
+    if (param == NULL || param->enum_info == NULL || row >= (unsigned int)param->enum_info->n_rows ||
+        value == NULL) {
+        return -1;
+    }
+    *value = param->enum_info->row_values[row];
+    return 0;
 }
 
 int32_t ParamGetValue(const struct param_t* param) {
-    int32_t ret_val = 0;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            ret_val = *param->value;
-        }
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return 0;
     }
-    return ret_val;
+    return param_value_load(param);
 }
 
 int ParamGetId(const struct param_t* param) {
-    int ret_val = 0;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            ret_val = param->id;
-        }
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return 0;
+    }
+    return param->id;
+}
+
+const char* ParamGetUnit(const struct param_t* param) {
+    if (param == NULL) {
+        return "";
     }
-    return ret_val;
+    return param->unit;
 }
 
 int32_t ParamGetMinValue(const struct param_t* param) {
-    int32_t ret_val = 0;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            ret_val = param->min;
-        }
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return 0;
     }
-    return ret_val;
+    return param->min;
 }
 
 int32_t ParamGetMaxValue(const struct param_t* param) {
-    int32_t ret_val = 0;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            ret_val = param->max;
-        }
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return 0;
     }
-    return ret_val;
+    return param->max;
 }
 
 int ParamGetExponent(const struct param_t* param) {
-    int ret_val = 0;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            ret_val = param->exponent;
-        }
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return 0;
     }
-    return ret_val;
+    return param->exponent;
 }
 
 int ParamIncreaseValue(const struct param_t* param) {
-    int rc = -1;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            if (*param->value == param->max) {
-                *param->value = param->min;
-            } else {
-                ++(*param->value);
-            }
-            rc = 0;
-        }
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return -1;
     }
-    return rc;
+    int32_t value = param_value_load(param);
+    // Retried if a setter changed the value since it was loaded, so that change is not lost
+    while (!param_value_cas(param, value, value == param->max ? param->min : value + 1)) {
+        value = param_value_load(param);
+    }
+    param_mark_dirty(param);
+    return 0;
 }
 
 int ParamDecreaseValue(const struct param_t* param) {
-    int rc = -1;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            if (*param->value == param->min) {
-                *param->value = param->max;
-            } else {
-                --(*param->value);
-            }
-            rc = 0;
-        }
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return -1;
     }
-    return rc;
+    int32_t value = param_value_load(param);
+    // Retried if a setter changed the value since it was loaded, so that change is not lost
+    while (!param_value_cas(param, value, value == param->min ? param->max : value - 1)) {
+        value = param_value_load(param);
+    }
+    param_mark_dirty(param);
+    return 0;
 }
 
 int ParamSetValue(const struct param_t* param, const int32_t value) {
+    if (param == NULL || value < param->min || value > param->max) {
+        return -1;
+    }
+    param_value_store(param, value);
+    param_mark_dirty(param);
+    return 0;
+}
+
+int ParamGetById(const int id, int32_t* value) {
+    const struct param_t* param = ParamFindById(id);
+    if (param == NULL || value == NULL) {
+        return -1;
+    }
+    *value = param_value_load(param);
+    return 0;
+}
+
+int ParamSetById(const int id, const int32_t value) { return ParamSetValue(ParamFindById(id), value); }
+
+void ParamTxBegin(struct param_tx* tx) {
+    if (tx != NULL) {
+        tx->n_changes = 0;
+        tx->failed = false;
+    }
+}
+
+int ParamTxSet(struct param_tx* tx, const struct param_t* param, const int32_t value) {
+    if (tx == NULL) {
+        return -1;
+    }
+    if (param == NULL || value < param->min || value > param->max || tx->n_changes >= PARAM_TX_MAX_CHANGES) {
+        tx->failed = true;
+        return -1;
+    }
+    tx->changes[tx->n_changes].param = param;
+    tx->changes[tx->n_changes].value = value;
+    ++tx->n_changes;
+    return 0;
+}
+
+static int tx_commit(struct param_tx* tx, const bool save) {
+    if (tx == NULL || tx->failed) {
+        ParamTxBegin(tx);
+        return -1;
+    }
+
     int rc = -1;
     if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL && value >= param->min && value <= param->max) {
-            *param->value = value;
-            rc = 0;
+        param_update_begin();
+        for (unsigned int i = 0; i < tx->n_changes; ++i) {
+            param_value_store(tx->changes[i].param, tx->changes[i].value);
+            if (save) {
+                param_set_dirty(tx->changes[i].param);
+            } else {
+                param_notify_changed(tx->changes[i].param);
+            }
+        }
+        param_update_end();
+        if (save && tx->n_changes > 0) {
+            param_write_behind_schedule();
         }
         k_mutex_unlock(&param_mutex);
+        rc = 0;
     }
+    ParamTxBegin(tx);
     return rc;
 }
 
+int ParamTxCommit(struct param_tx* tx) { return tx_commit(tx, true); }
+
+int ParamTxApply(struct param_tx* tx) { return tx_commit(tx, false); }
+
 bool ParamIsEnum(const struct param_t* param) {
-    bool is_enum = false;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (param != NULL) {
-            is_enum = param->type == kParamTypeEnum;
-        }
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return false;
     }
-    return is_enum;
+    return param->type == kParamTypeEnum;
 }
 
 int ParamCategoryGetNParams(const struct param_category_t* category, const unsigned int access_level) {
@@ -141,52 +248,97 @@ int ParamCategoryGetNParams(const struct param_category_t* category, const unsig
 }
 
 int ParamCategoryGetTotalNParams(const struct param_category_t* category) {
-    int ret_val = -ENOENT;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (category != NULL) {
-            // Highest access level contains all parameters
-            ret_val = category->n_params[PARAM_ACCESS_LEVELS - 1];
-        }
-        k_mutex_unlock(&param_mutex);
+    if (category == NULL) {
+        return -ENOENT;
     }
-    return ret_val;
+    // Highest access level contains all parameters
+    return category->n_params[PARAM_ACCESS_LEVELS - 1];
 }
 
 int ParamCategoryGetParam(const struct param_category_t* category,
                           const struct param_t** param,
                           const unsigned int index) {
-    int rc = -EINVAL;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (category != NULL) {
-            // Highest access level contains all parameters
-            if (index < category->n_params[PARAM_ACCESS_LEVELS - 1]) {
-                *param = category->params[index];
-                rc = 0;
-            }
-        }
-        k_mutex_unlock(&param_mutex);
+    // Highest access level contains all parameters
+    if (category == NULL || index >= category->n_params[PARAM_ACCESS_LEVELS - 1]) {
+        return -EINVAL;
     }
-    return rc;
+    *param = category->params[index];
+    return 0;
 }
 
 int ParamGetCategoryName(const struct param_category_t* category, char* buf) {
-    int rc = -1;
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        if (category != NULL) {
-            strncpy(buf, category->name, PARAM_CATEGORY_NAME_MAX_LEN);
-            rc = 0;
+    if (category == NULL) {
+        return -1;
+    }
+    strncpy(buf, category->name, PARAM_CATEGORY_NAME_MAX_LEN);
+    return 0;
+}
+
+const char* ParamCategoryNamePtr(const struct param_category_t* category) {
+    if (category == NULL) {
+        return "";
+    }
+    return category->name;
+}
+
+static const uint32_t pow10_[] = {1,      10,      100,      1000,      10000,
+                                  100000, 1000000, 10000000, 100000000, 1000000000};
+
+int param_format_fixed(char* buf, const size_t size, const int32_t value, const int exponent) {
+    const int n_decimals = exponent < 0 ? -exponent : 0;
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+
+    int n_digits = 1;
+    while (n_digits < (int)ARRAY_SIZE(pow10_) && magnitude >= pow10_[n_digits]) {
+        ++n_digits;
+    }
+    // At least one digit before the decimal point
+    if (n_digits <= n_decimals) {
+        n_digits = n_decimals + 1;
+    }
+
+    const size_t len = (value < 0 ? 1 : 0) + n_digits + (n_decimals > 0 ? 1 : 0);
+    if (len >= size) {
+        return -1;
+    }
+
+    // Emitted from the last digit backwards
+    char* p = buf + len;
+    *p = '\0';
+    for (int i = 0; i < n_digits; ++i) {
+        if (i == n_decimals && n_decimals > 0) {
+            *--p = '.';
         }
-        k_mutex_unlock(&param_mutex);
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
     }
-    return rc;
+    if (value < 0) {
+        *--p = '-';
+    }
+    return 0;
+}
+
+int ParamGetValueString(const struct param_t* param, char* buf, const int32_t value) {
+    if (param == NULL || value < param->min || value > param->max) {
+        return -1;
+    }
+
+    if (param->enum_info != NULL) {
+        const char* label = ParamEnumLabelPtr(param, value);
+        if (label == NULL) {
+            return -1;
+        }
+        strncpy(buf, label, PARAM_VALUE_STRING_MAX_LEN);
+        return 0;
+    }
+    return param_format_fixed(buf, PARAM_VALUE_STRING_MAX_LEN, value, param->exponent);
 }
 
 int ParamGetCurrentValueString(const struct param_t* param, char* buf) {
-    if (k_mutex_lock(&param_mutex, K_FOREVER) == 0) {
-        return ParamGetValueString(param, buf, *param->value);
-        k_mutex_unlock(&param_mutex);
+    if (param == NULL) {
+        return -1;
     }
-    return -1;
+    return ParamGetValueString(param, buf, param_value_load(param));
 }
 
 int ParamCategoryWalk(param_category_walk_cb_t cb, const unsigned int access_level, void* arg) {
@@ -217,7 +369,8 @@ int ParamWalk(param_walk_cb_t cb, const struct param_category_t* category, const
     }
 
     const struct param_t* parameter;
-    for (unsigned int par_i = 0; par_i < ParamCategoryGetNParams(category, access_level); ++par_i) {
+    const unsigned int n_params = category->n_params[access_level];
+    for (unsigned int par_i = 0; par_i < n_params; ++par_i) {
         if (ParamCategoryGetParam(category, &parameter, par_i) != 0) {
             return -ENOENT;
         }
@@ -230,3 +383,45 @@ int ParamWalk(param_walk_cb_t cb, const struct param_category_t* category, const
 
     return 0;
 }
+
+int ParamRowWalk(param_row_walk_cb_t cb,
+                 const struct param_category_t* category,
+                 const unsigned int access_level,
+                 void* arg) {
+    if (access_level >= PARAM_ACCESS_LEVELS || cb == NULL || category == NULL) {
+        return -EINVAL;
+    }
+
+    const unsigned int n_params = category->n_params[access_level];
+    int32_t values[PARAM_MAX_NUM_PARAMS_IN_CATEGORY];
+    if (k_mutex_lock(&param_mutex, K_FOREVER) != 0) {
+        return -EAGAIN;
+    }
+    for (unsigned int i = 0; i < n_params; ++i) {
+        values[i] = param_value_load(category->params[i]);
+    }
+    k_mutex_unlock(&param_mutex);
+
+    struct param_row row;
+    for (unsigned int i = 0; i < n_params; ++i) {
+        const struct param_t* param = category->params[i];
+        row.param = param;
+        row.name = param_name(param);
+        row.unit = param->unit;
+        row.value = values[i];
+        if (ParamGetValueString(param, row.value_string, values[i]) != 0) {
+            row.value_string[0] = '\0';
+        }
+        row.min = param->min;
+        row.max = param->max;
+        row.exponent = param->exponent;
+        row.is_enum = param->type == kParamTypeEnum;
+
+        if (cb(&row, arg) < 0) {
+            // Walk interrupted by callback return code
+            return 0;
+        }
+    }
+
+    return 0;
+}
@@ -1,20 +1,41 @@
 #ifndef KOSTER_COMMON_PARAMETERS_PRIVATE_H
 #define KOSTER_COMMON_PARAMETERS_PRIVATE_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef enum { kParamTypeEnum, kParamTypeNumeric } param_type_t;
 
+// The C type a value is kept in, the narrowest one that holds the parameter type
+typedef enum {
+    kParamStorageU8,
+    kParamStorageI8,
+    kParamStorageU16,
+    kParamStorageI16,
+    kParamStorageI32
+} param_storage_t;
+
+struct param_enum_info_t {
+    const char* const* labels;  // by value, NULL for values that are not in the enum
+    int32_t n_labels;
+    const char* options;        // the labels in value order, separated by '\n'
+    const int32_t* row_values;  // value of each line in options
+    const int16_t* value_rows;  // by value, line in options or -1 for values that are not in the enum
+    int32_t n_rows;
+};
+
 struct param_t {
     int id;
-    const char* name;
     param_type_t type;
     int access;
-    const char* description;
-    int32_t* value;
+    void* value;  // of the type given by storage
+    param_storage_t storage;
     int32_t min;
     int32_t max;
     int exponent;
+    const char* unit;  // "" if the parameter has no unit
+    const struct param_enum_info_t* enum_info;  // NULL for numeric parameters
 };
 
 struct param_category_t {
@@ -24,4 +45,135 @@ struct param_category_t {
     const struct param_t* params[PARAM_MAX_NUM_PARAMS_IN_CATEGORY];
 };
 
+// The param_t and param_category_t tables are const and are read without param_mutex. Values are single
+// aligned variables that are read without the lock as well, so every access goes through these helpers,
+// which widen to and narrow from int32_t. With a param_t from the const table the switch is resolved at
+// compile time. Read-modify-write of one value uses param_value_cas(), param_mutex only serializes updates of
+// several values.
+
+static inline int32_t param_value_load(const struct param_t* param) {
+    switch (param->storage) {
+        case kParamStorageU8:
+            return __atomic_load_n((const uint8_t*)param->value, __ATOMIC_RELAXED);
+        case kParamStorageI8:
+            return __atomic_load_n((const int8_t*)param->value, __ATOMIC_RELAXED);
+        case kParamStorageU16:
+            return __atomic_load_n((const uint16_t*)param->value, __ATOMIC_RELAXED);
+        case kParamStorageI16:
+            return __atomic_load_n((const int16_t*)param->value, __ATOMIC_RELAXED);
+        default:
+            return __atomic_load_n((const int32_t*)param->value, __ATOMIC_RELAXED);
+    }
+}
+
+// The value must be in the range of the parameter, which fits its storage type
+static inline void param_value_store(const struct param_t* param, const int32_t new_value) {
+    switch (param->storage) {
+        case kParamStorageU8:
+            __atomic_store_n((uint8_t*)param->value, (uint8_t)new_value, __ATOMIC_RELAXED);
+            break;
+        case kParamStorageI8:
+            __atomic_store_n((int8_t*)param->value, (int8_t)new_value, __ATOMIC_RELAXED);
+            break;
+        case kParamStorageU16:
+            __atomic_store_n((uint16_t*)param->value, (uint16_t)new_value, __ATOMIC_RELAXED);
+            break;
+        case kParamStorageI16:
+            __atomic_store_n((int16_t*)param->value, (int16_t)new_value, __ATOMIC_RELAXED);
+            break;
+        default:
+            __atomic_store_n((int32_t*)param->value, new_value, __ATOMIC_RELAXED);
+            break;
+    }
+}
+
+// Store new_value if the value still is expected. Returns false, and stores nothing, if it has changed since.
+static inline bool param_value_cas(const struct param_t* param, const int32_t expected, const int32_t new_value) {
+    switch (param->storage) {
+        case kParamStorageU8: {
+            uint8_t old = (uint8_t)expected;
+            return __atomic_compare_exchange_n((uint8_t*)param->value, &old, (uint8_t)new_value, false,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        case kParamStorageI8: {
+            int8_t old = (int8_t)expected;
+            return __atomic_compare_exchange_n((int8_t*)param->value, &old, (int8_t)new_value, false,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        case kParamStorageU16: {
+            uint16_t old = (uint16_t)expected;
+            return __atomic_compare_exchange_n((uint16_t*)param->value, &old, (uint16_t)new_value, false,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        case kParamStorageI16: {
+            int16_t old = (int16_t)expected;
+            return __atomic_compare_exchange_n((int16_t*)param->value, &old, (int16_t)new_value, false,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        default: {
+            int32_t old = expected;
+            return __atomic_compare_exchange_n((int32_t*)param->value, &old, new_value, false, __ATOMIC_RELAXED,
+                                               __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * Format value * 10^exponent with -exponent decimals (as "%.*f" would), using integer arithmetic only.
+ * Positive exponents are not applied.
+ *
+ * @return 0 on success, -1 if the string does not fit in size bytes
+ */
+int param_format_fixed(char* buf, const size_t size, const int32_t value, const int exponent);
+
+/**
+ * Get the name of a parameter in the current language, see ParamSelectLanguage(). Defined in generated code.
+ */
+const char* param_name(const struct param_t* param);
+
+/**
+ * Get the description of a parameter in the current language, see ParamSelectLanguage(). Defined in generated code.
+ */
+const char* param_description(const struct param_t* param);
+
+/**
+ * Mark a parameter as changed since it was last saved, see ParamFlush(). Defined in generated code.
+ */
+void param_mark_dirty(const struct param_t* param);
+
+/**
+ * Mark a parameter as changed like param_mark_dirty(), without scheduling the write-behind flush. For updates
+ * of several values, which call param_write_behind_schedule() once. Defined in generated code.
+ */
+void param_set_dirty(const struct param_t* param);
+
+/**
+ * Publish a changed value in the next kMsgParamChanged message without marking it as unsaved. Defined in
+ * generated code.
+ */
+void param_notify_changed(const struct param_t* param);
+
+/**
+ * Bracket the stores of an update of several values, so that ParamReadBegin() readers retry instead of seeing
+ * part of it. Must be called with param_mutex held.
+ */
+void param_update_begin();
+void param_update_end();
+
+#if defined(CONFIG_KOSTER_COMMON_PARAM_WRITE_BEHIND)
+/**
+ * Set up the write-behind work items. Called by ParamInit().
+ */
+void param_write_behind_init();
+
+/**
+ * (Re)start the quiet period after which changed parameters are saved. Called whenever a parameter is marked
+ * as changed.
+ */
+void param_write_behind_schedule();
+#else
+static inline void param_write_behind_init() {}
+static inline void param_write_behind_schedule() {}
+#endif
+
 #endif
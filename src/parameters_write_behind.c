@@ -0,0 +1,64 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "koster-common/koster-zbus.h"
+#include "koster-common/parameters.h"
+#include "parameters_private.h"
+
+LOG_MODULE_DECLARE(koster_common);
+
+#if defined(CONFIG_KOSTER_COMMON_PARAM_WRITE_BEHIND_DELAY_MS)
+#define PARAM_WRITE_BEHIND_DELAY_MS CONFIG_KOSTER_COMMON_PARAM_WRITE_BEHIND_DELAY_MS
+#else
+#define PARAM_WRITE_BEHIND_DELAY_MS 2000
+#endif
+
+#if defined(CONFIG_KOSTER_COMMON_PARAM_WRITE_BEHIND_MAX_DELAY_MS)
+#define PARAM_WRITE_BEHIND_MAX_DELAY_MS CONFIG_KOSTER_COMMON_PARAM_WRITE_BEHIND_MAX_DELAY_MS
+#else
+#define PARAM_WRITE_BEHIND_MAX_DELAY_MS 30000
+#endif
+
+// Rescheduled on every change, runs once the values have been left alone for the quiet period
+static struct k_work_delayable quiet_work_;
+// Scheduled by the first unsaved change only, bounds how long changes stay unsaved while values keep changing
+static struct k_work_delayable deadline_work_;
+
+static void flush_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    // Cancelled before flushing, so a change made during the flush schedules a new one
+    k_work_cancel_delayable(&quiet_work_);
+    k_work_cancel_delayable(&deadline_work_);
+
+    const int rc = ParamFlush();
+    if (rc < 0) {
+        LOG_ERR("[parameters] Write-behind flush failed (err %d), retrying", rc);
+        param_write_behind_schedule();
+    }
+}
+
+void param_write_behind_init() {
+    k_work_init_delayable(&quiet_work_, flush_work_handler);
+    k_work_init_delayable(&deadline_work_, flush_work_handler);
+}
+
+void param_write_behind_schedule() {
+    k_work_reschedule(&quiet_work_, K_MSEC(PARAM_WRITE_BEHIND_DELAY_MS));
+    // Does nothing if already scheduled
+    k_work_schedule(&deadline_work_, K_MSEC(PARAM_WRITE_BEHIND_MAX_DELAY_MS));
+}
+
+static void control_listener_cb(const struct zbus_channel *chan) {
+    const struct kzbus_msg_t *msg = zbus_chan_const_msg(chan);
+
+    // Save pending changes before the program starts, the flash write runs on the system work queue and not
+    // in the publisher's thread
+    if (msg->msg_type == kMsgReqStart && ParamHasUnsavedChanges()) {
+        k_work_reschedule(&quiet_work_, K_NO_WAIT);
+    }
+}
+
+ZBUS_LISTENER_DEFINE(param_write_behind_listener, control_listener_cb);
+ZBUS_CHAN_ADD_OBS(kzbus_control_chan, param_write_behind_listener, 3);
@@ -18,13 +18,18 @@ static const struct device* const rtc = DEVICE_DT_GET(DT_ALIAS(rtc));
 
 int RtcSetFromParameters() {
     struct rtc_time time;
-    time.tm_year = (ParamGetYear() - TM_YEAR_REF);
-    time.tm_mon = ParamGetMonth() - 1;  // from [1,12] to [0,11]
-    time.tm_mday = ParamGetDay();
-    time.tm_hour = ParamGetHour();
-    time.tm_min = ParamGetMinute();
-    time.tm_sec = ParamGetSecond();
-    time.tm_wday = ParamGetWeekday();
+    // Read again if RtcToParameters() applied a new time meanwhile, so the fields are never mixed
+    unsigned int seq;
+    do {
+        seq = ParamReadBegin();
+        time.tm_year = (ParamGetYear() - TM_YEAR_REF);
+        time.tm_mon = ParamGetMonth() - 1;  // from [1,12] to [0,11]
+        time.tm_mday = ParamGetDay();
+        time.tm_hour = ParamGetHour();
+        time.tm_min = ParamGetMinute();
+        time.tm_sec = ParamGetSecond();
+        time.tm_wday = ParamGetWeekday();
+    } while (ParamReadRetry(seq));
     time.tm_yday = -1;  // Unknown yearday
 
     return rtc_set_time(rtc, &time);
@@ -38,15 +43,19 @@ int RtcToParameters() {
         return rc;
     }
 
-    rc += ParamSetYear(time.tm_year + TM_YEAR_REF);
-    rc += ParamSetMonth(time.tm_mon + 1);  // from [0,11] to [1,12]
-    rc += ParamSetDay(time.tm_mday);
-    rc += ParamSetHour(time.tm_hour);
-    rc += ParamSetMinute(time.tm_min);
-    rc += ParamSetSecond(time.tm_sec);
-    rc += ParamSetWeekday(time.tm_wday);
-
-    return rc;
+    // Applied together, so the date and time parameters are never read or published half updated. Not marked as
+    // unsaved, write-behind would otherwise save the RTC time on every sync.
+    struct param_tx tx;
+    ParamTxBegin(&tx);
+    ParamTxSetYear(&tx, time.tm_year + TM_YEAR_REF);
+    ParamTxSetMonth(&tx, time.tm_mon + 1);  // from [0,11] to [1,12]
+    ParamTxSetDay(&tx, time.tm_mday);
+    ParamTxSetHour(&tx, time.tm_hour);
+    ParamTxSetMinute(&tx, time.tm_min);
+    ParamTxSetSecond(&tx, time.tm_sec);
+    ParamTxSetWeekday(&tx, time.tm_wday);
+
+    return ParamTxApply(&tx);
 }
 
 uint32_t RtcGetEpoch() {
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -5,16 +6,40 @@
 extern "C" {
 #include "fff/fff.h"
 #include "koster-common/alarm.h"
+#include "koster-common/alarm_stats.h"
+#include "koster-common/koster-zbus.h"
+#include "zephyr/settings/settings.h"
 #include "zephyr/zbus/zbus.h"
-}
 
 DEFINE_FFF_GLOBALS;
+FAKE_VALUE_FUNC(uint32_t, RtcGetEpoch);
 
+extern const struct zbus_channel kzbus_alarm_chan;
 const struct zbus_channel kzbus_alarm_chan;
+}
 
-constexpr uint8_t kTypeAAlarmId{1};
+constexpr alarm_origin_t kAlarmOriginTest1{kAlarmOriginKoster};
+constexpr alarm_origin_t kAlarmOriginTest2{kAlarmOriginVinga1};
+constexpr uint8_t kTypeAAlarmId{2};
 constexpr alarm_origin_t kTypeAAlarmOrigin{kAlarmOriginTest1};
-constexpr int kAlarmMaxAlarms{20};
+constexpr int kAlarmMaxAlarms{ALARM_MAX_ALARMS};
+
+std::vector<kzbus_msg_t> published_;
+int zbus_chan_pub_capture(const struct zbus_channel*, const void* msg, k_timeout_t) {
+    published_.push_back(*static_cast<const kzbus_msg_t*>(msg));
+    return 0;
+}
+
+// Run the handler registered for a delayable work item, as the work queue would
+void run_work(struct k_work_delayable* dwork) {
+    for (unsigned int i = 0; i < k_work_init_delayable_fake.call_count; ++i) {
+        if (k_work_init_delayable_fake.arg0_history[i] == dwork) {
+            k_work_init_delayable_fake.arg1_history[i](&dwork->work);
+            return;
+        }
+    }
+    FAIL() << "work item was never initialized";
+}
 
 std::vector<alarm_t> alarm_walk_entries_;
 int walk_callback(const alarm_t alarm, void*) {
@@ -22,11 +47,50 @@ int walk_callback(const alarm_t alarm, void*) {
     return 0;
 }
 
+std::vector<alarm_stats_t> stats_walk_entries_;
+int stats_walk_callback(const alarm_stats_t* stats, void*) {
+    stats_walk_entries_.push_back(*stats);
+    return 0;
+}
+
+alarm_stats_t stored_stats_;
+ssize_t read_stored_stats(void*, void* data, size_t len) {
+    memcpy(data, &stored_stats_, len);
+    return len;
+}
+
+int name_next(const char* name, const char** next) {
+    *next = NULL;
+    return strlen(name);
+}
+
+int set_stored_stats(const char* name) {
+    return settings_register_fake.arg0_val->h_set(name, sizeof(stored_stats_), read_stored_stats, NULL);
+}
+
+// Loads alarm/stats, as the settings subsystem would for the "alarm" subtree
+int load_stored_stats(const char*) { return set_stored_stats("stats"); }
+
+int walk_and_clear_callback(const alarm_t alarm, void*) {
+    alarm_walk_entries_.push_back(alarm);
+    return AlarmSet(false, alarm.id & ALARM_ERROR_ID_MASK, (alarm_origin_t)(alarm.id & ALARM_ORIGIN_MASK));
+}
+
 class AlarmTests : public testing::Test {
   protected:
     void SetUp() override {
+        RESET_FAKE(RtcGetEpoch);
+        RESET_FAKE(k_uptime_get);
+        RESET_FAKE(k_work_init_delayable);
+        RESET_FAKE(k_work_schedule);
+        RESET_FAKE(k_work_reschedule);
+        RESET_FAKE(zbus_chan_pub);
+        RESET_FAKE(settings_save_one);
+        zbus_chan_pub_fake.custom_fake = zbus_chan_pub_capture;
         AlarmInit();
         alarm_walk_entries_.clear();
+        stats_walk_entries_.clear();
+        published_.clear();
     };
 };
 
@@ -111,3 +175,409 @@ TEST_F(AlarmTests, AlarmSetAndClearAFewEntries_AlarmIsActiveReturnsCorrect) {
     ASSERT_TRUE(AlarmIsActive(5, &origin));
     ASSERT_EQ(origin, kAlarmOriginTest1);
 }
+
+TEST_F(AlarmTests, AlarmSnapshot_ContainsActiveAlarms) {
+    struct alarm_snapshot snapshot;
+    ASSERT_EQ(AlarmSnapshot(&snapshot), 0);
+    ASSERT_EQ(snapshot.n_alarms, 0);
+    const uint32_t initial_generation = snapshot.generation;
+
+    RtcGetEpoch_fake.return_val = 1234;
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(true, 2, kAlarmOriginTest2), 0);
+    ASSERT_EQ(AlarmSnapshot(&snapshot), 0);
+    ASSERT_EQ(snapshot.n_alarms, 2);
+    ASSERT_EQ(snapshot.generation, initial_generation + 2);
+    ASSERT_EQ(snapshot.alarms[0].id, 1 | kAlarmOriginTest1);
+    ASSERT_EQ(snapshot.alarms[0].epoch, 1234);
+    ASSERT_EQ(snapshot.alarms[1].id, 2 | kAlarmOriginTest2);
+
+    ASSERT_EQ(AlarmSet(false, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSnapshot(&snapshot), 0);
+    ASSERT_EQ(snapshot.n_alarms, 1);
+    ASSERT_EQ(snapshot.generation, initial_generation + 3);
+    ASSERT_EQ(snapshot.alarms[0].id, 2 | kAlarmOriginTest2);
+}
+
+TEST_F(AlarmTests, AlarmSnapshot_NullReturnsError) { ASSERT_EQ(AlarmSnapshot(NULL), -EINVAL); }
+
+TEST_F(AlarmTests, AlarmWalk_CallbackMayClearAlarms) {
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(true, 2, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(true, 3, kAlarmOriginTest1), 0);
+
+    // The walk iterates over a snapshot, so clearing inside the callback neither deadlocks nor skips entries
+    ASSERT_EQ(AlarmWalk(walk_and_clear_callback, NULL), 0);
+    ASSERT_EQ(alarm_walk_entries_.size(), 3);
+
+    alarm_walk_entries_.clear();
+    ASSERT_EQ(AlarmWalk(walk_callback, NULL), 0);
+    ASSERT_EQ(alarm_walk_entries_.size(), 0);
+}
+
+TEST_F(AlarmTests, AlarmSet_RaisingActiveAlarmAgainDoesNothing) {
+    RtcGetEpoch_fake.return_val = 1234;
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    RtcGetEpoch_fake.return_val = 5678;
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(published_.size(), 1);
+    struct alarm_snapshot snapshot;
+    ASSERT_EQ(AlarmSnapshot(&snapshot), 0);
+    ASSERT_EQ(snapshot.alarms[0].epoch, 1234);
+    ASSERT_EQ(AlarmWalk(walk_callback, NULL), 0);
+    ASSERT_EQ(alarm_walk_entries_.size(), 1);
+}
+
+TEST_F(AlarmTests, AlarmSet_ClearIsHeldOff) {
+    ASSERT_EQ(AlarmSetHoldOff(1 | kAlarmOriginTest1, 100), 0);
+    k_uptime_get_fake.return_val = 1000;
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(false, 1, kAlarmOriginTest1), 0);
+    ASSERT_TRUE(AlarmIsActive(1, NULL));
+    ASSERT_EQ(k_work_reschedule_fake.arg1_val, 100);
+
+    // Flapping within the hold-off is neither published nor timestamped
+    k_uptime_get_fake.return_val = 1050;
+    const uint32_t raised_epoch = RtcGetEpoch_fake.return_val;
+    RtcGetEpoch_fake.return_val = raised_epoch + 50;
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(false, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(published_.size(), 1);
+    struct alarm_snapshot snapshot;
+    ASSERT_EQ(AlarmSnapshot(&snapshot), 0);
+    ASSERT_EQ(snapshot.alarms[0].epoch, raised_epoch);
+
+    // Hold-off restarted by the last clear
+    k_uptime_get_fake.return_val = 1100;
+    run_work(k_work_reschedule_fake.arg0_val);
+    ASSERT_TRUE(AlarmIsActive(1, NULL));
+
+    k_uptime_get_fake.return_val = 1150;
+    run_work(k_work_reschedule_fake.arg0_val);
+    ASSERT_FALSE(AlarmIsActive(1, NULL));
+    ASSERT_EQ(published_.size(), 2);
+    ASSERT_EQ(published_.at(1).msg_type, kMsgAlarm);
+    ASSERT_FALSE(published_.at(1).alarm_msg.alarm_active);
+    ASSERT_EQ(published_.at(1).alarm_msg.alarm_id, 1 | kAlarmOriginTest1);
+}
+
+TEST_F(AlarmTests, AlarmSet_ChangesAreCoalescedWithinWindow) {
+    AlarmSetNotifyWindow(50);
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(true, 4, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(true, 5, kAlarmOriginTest2), 0);
+    ASSERT_EQ(published_.size(), 0);
+    ASSERT_EQ(k_work_schedule_fake.arg1_val, 50);
+
+    run_work(k_work_schedule_fake.arg0_val);
+    ASSERT_EQ(published_.size(), 1);
+    ASSERT_EQ(published_.at(0).msg_type, kMsgAlarmBatch);
+    ASSERT_EQ(published_.at(0).alarm_batch_msg.n_changes, 3);
+    ASSERT_EQ(published_.at(0).alarm_batch_msg.changes[0].alarm_id, 1 | kAlarmOriginTest1);
+    ASSERT_EQ(published_.at(0).alarm_batch_msg.changes[1].alarm_id, 4 | kAlarmOriginTest1);
+    ASSERT_EQ(published_.at(0).alarm_batch_msg.changes[2].alarm_id, 5 | kAlarmOriginTest2);
+    ASSERT_TRUE(published_.at(0).alarm_batch_msg.changes[2].alarm_active);
+}
+
+TEST_F(AlarmTests, AlarmSet_TypeAAlarmIsPublishedImmediately) {
+    AlarmSetNotifyWindow(50);
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(published_.size(), 0);
+    ASSERT_EQ(AlarmSet(true, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_EQ(published_.size(), 1);
+    ASSERT_EQ(published_.at(0).alarm_batch_msg.n_changes, 2);
+    ASSERT_EQ(published_.at(0).alarm_batch_msg.changes[1].alarm_id, kTypeAAlarmId | kTypeAAlarmOrigin);
+}
+
+TEST_F(AlarmTests, AlarmSet_ToggleWithinWindowIsNotPublished) {
+    AlarmSetNotifyWindow(50);
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(false, 1, kAlarmOriginTest1), 0);
+    run_work(k_work_schedule_fake.arg0_val);
+    ASSERT_EQ(published_.size(), 0);
+}
+
+TEST_F(AlarmTests, AlarmSetMask_AppliesDifferenceAsOneBatch) {
+    ASSERT_EQ(AlarmSet(true, 7, kAlarmOriginTest1), 0);
+    published_.clear();
+
+    uint8_t bitmap[ALARM_ERROR_BITMAP_SIZE] = {0};
+    bitmap[0] = (1 << 1) | (1 << 3);
+    bitmap[1] = (1 << (10 % 8));
+    RESET_FAKE(RtcGetEpoch);
+    ASSERT_EQ(AlarmSetMask(kAlarmOriginTest2, bitmap), 0);
+    // Read once for all three changes
+    ASSERT_EQ(RtcGetEpoch_fake.call_count, 1);
+    ASSERT_EQ(published_.size(), 1);
+    ASSERT_EQ(published_.at(0).msg_type, kMsgAlarmBatch);
+    ASSERT_EQ(published_.at(0).alarm_batch_msg.n_changes, 3);
+
+    alarm_origin_t origin;
+    ASSERT_TRUE(AlarmIsActive(10, &origin));
+    ASSERT_EQ(origin, kAlarmOriginTest2);
+
+    // Error 1 cleared, error 4 raised, error 3 and 10 unchanged
+    bitmap[0] = (1 << 3) | (1 << 4);
+    ASSERT_EQ(AlarmSetMask(kAlarmOriginTest2, bitmap), 0);
+    ASSERT_EQ(published_.size(), 2);
+    ASSERT_EQ(published_.at(1).alarm_batch_msg.n_changes, 2);
+    ASSERT_EQ(published_.at(1).alarm_batch_msg.changes[0].alarm_id, 1 | kAlarmOriginTest2);
+    ASSERT_FALSE(published_.at(1).alarm_batch_msg.changes[0].alarm_active);
+    ASSERT_EQ(published_.at(1).alarm_batch_msg.changes[1].alarm_id, 4 | kAlarmOriginTest2);
+    ASSERT_TRUE(published_.at(1).alarm_batch_msg.changes[1].alarm_active);
+
+    // Alarms from other origins are left alone
+    ASSERT_TRUE(AlarmIsActive(7, &origin));
+    ASSERT_EQ(origin, kAlarmOriginTest1);
+    ASSERT_EQ(AlarmWalk(walk_callback, NULL), 0);
+    ASSERT_EQ(alarm_walk_entries_.size(), 4);
+}
+
+TEST_F(AlarmTests, AlarmSetMask_UnchangedMaskPublishesNothing) {
+    uint8_t bitmap[ALARM_ERROR_BITMAP_SIZE] = {0};
+    bitmap[0] = (1 << 1);
+    ASSERT_EQ(AlarmSetMask(kAlarmOriginTest2, bitmap), 0);
+    ASSERT_EQ(AlarmSetMask(kAlarmOriginTest2, bitmap), 0);
+    ASSERT_EQ(published_.size(), 1);
+    ASSERT_EQ(published_.at(0).msg_type, kMsgAlarm);
+}
+
+TEST_F(AlarmTests, AlarmStats_CountsRaisesAndActiveTime) {
+    struct alarm_stats_t stats;
+    ASSERT_EQ(AlarmStatsGet(1 | kAlarmOriginTest1, &stats), -ENOENT);
+
+    k_uptime_get_fake.return_val = 1000;
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    k_uptime_get_fake.return_val = 1300;
+    ASSERT_EQ(AlarmSet(false, 1, kAlarmOriginTest1), 0);
+    k_uptime_get_fake.return_val = 2000;
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+
+    // The current activation is included
+    k_uptime_get_fake.return_val = 2500;
+    ASSERT_EQ(AlarmStatsGet(1 | kAlarmOriginTest1, &stats), 0);
+    ASSERT_EQ(stats.alarm_id, 1 | kAlarmOriginTest1);
+    ASSERT_EQ(stats.count, 2);
+    ASSERT_EQ(stats.active_ms, 800);
+
+    k_uptime_get_fake.return_val = 3000;
+    ASSERT_EQ(AlarmSet(false, 1, kAlarmOriginTest1), 0);
+    k_uptime_get_fake.return_val = 9000;
+    ASSERT_EQ(AlarmStatsGet(1 | kAlarmOriginTest1, &stats), 0);
+    ASSERT_EQ(stats.count, 2);
+    ASSERT_EQ(stats.active_ms, 1300);
+}
+
+TEST_F(AlarmTests, AlarmStats_WalkAndPersistReportEveryRaisedAlarm) {
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest2), 0);
+    ASSERT_EQ(AlarmSet(false, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+
+    ASSERT_EQ(AlarmStatsWalk(stats_walk_callback, NULL), 2);
+    ASSERT_EQ(stats_walk_entries_.size(), 2);
+    for (const auto& stats : stats_walk_entries_) {
+        ASSERT_EQ(stats.count, stats.alarm_id == (1 | kAlarmOriginTest1) ? 2 : 1);
+    }
+
+    ASSERT_EQ(AlarmStatsPersist(), 0);
+    ASSERT_EQ(settings_save_one_fake.call_count, 1);
+    ASSERT_STREQ(settings_save_one_fake.arg0_val, "alarm/stats");
+    ASSERT_EQ(settings_save_one_fake.arg2_val, 2 * sizeof(alarm_stats_t));
+}
+
+TEST_F(AlarmTests, AlarmStatsInit_LoadsOnlyItsOwnSettings) {
+    RESET_FAKE(settings_load);
+    RESET_FAKE(settings_load_subtree);
+    RESET_FAKE(settings_register);
+    ASSERT_EQ(AlarmStatsInit(), 0);
+    ASSERT_EQ(settings_load_fake.call_count, 0);
+    ASSERT_EQ(settings_load_subtree_fake.call_count, 1);
+    ASSERT_STREQ(settings_load_subtree_fake.arg0_val, settings_register_fake.arg0_val->name);
+    ASSERT_STREQ(settings_load_subtree_fake.arg0_val, "alarm");
+}
+
+TEST_F(AlarmTests, AlarmStatsInit_AddsStoredStatisticsOnce) {
+    settings_name_next_fake.custom_fake = name_next;
+    settings_load_subtree_fake.custom_fake = load_stored_stats;
+    stored_stats_ = {.alarm_id = 1 | kAlarmOriginTest1, .count = 5, .active_ms = 1000};
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(false, 1, kAlarmOriginTest1), 0);
+
+    ASSERT_EQ(AlarmStatsInit(), 0);
+    alarm_stats_t stats;
+    ASSERT_EQ(AlarmStatsGet(1 | kAlarmOriginTest1, &stats), 0);
+    ASSERT_EQ(stats.count, 6u);
+    ASSERT_EQ(stats.active_ms, 1000u);
+
+    // The application loading all settings again must not add them a second time
+    ASSERT_EQ(set_stored_stats("stats"), 0);
+    ASSERT_EQ(AlarmStatsGet(1 | kAlarmOriginTest1, &stats), 0);
+    ASSERT_EQ(stats.count, 6u);
+
+    settings_load_subtree_fake.custom_fake = NULL;
+    settings_name_next_fake.custom_fake = NULL;
+}
+
+TEST_F(AlarmTests, AlarmStatsInit_OnlyWholeNameMatches) {
+    settings_name_next_fake.custom_fake = name_next;
+    ASSERT_EQ(AlarmStatsInit(), 0);
+
+    ASSERT_EQ(set_stored_stats("s"), -ENOENT);
+    ASSERT_EQ(set_stored_stats(""), -ENOENT);
+    ASSERT_EQ(set_stored_stats("statsX"), -ENOENT);
+    ASSERT_EQ(set_stored_stats("stats"), 0);
+
+    settings_name_next_fake.custom_fake = NULL;
+}
+
+TEST_F(AlarmTests, AlarmStats_ResetKeepsCountingActiveAlarms) {
+    k_uptime_get_fake.return_val = 1000;
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(true, 2, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(false, 2, kAlarmOriginTest1), 0);
+
+    k_uptime_get_fake.return_val = 2000;
+    ASSERT_EQ(AlarmStatsReset(), 0);
+    ASSERT_EQ(settings_save_one_fake.arg2_val, sizeof(alarm_stats_t));
+
+    struct alarm_stats_t stats;
+    ASSERT_EQ(AlarmStatsGet(2 | kAlarmOriginTest1, &stats), -ENOENT);
+    k_uptime_get_fake.return_val = 2100;
+    ASSERT_EQ(AlarmStatsGet(1 | kAlarmOriginTest1, &stats), 0);
+    ASSERT_EQ(stats.count, 0);
+    ASSERT_EQ(stats.active_ms, 100);
+
+    // A cleared entry is counted again after the reset
+    ASSERT_EQ(AlarmSet(true, 2, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmStatsGet(2 | kAlarmOriginTest1, &stats), 0);
+    ASSERT_EQ(stats.count, 1);
+}
+
+TEST_F(AlarmTests, AlarmGetTopActive_OrdersByTypeThenRaiseTime) {
+    struct alarm_t top;
+    ASSERT_EQ(AlarmGetTopActive(&top), -ENOENT);
+
+    ASSERT_EQ(AlarmSet(true, 0x30, kAlarmOriginTest2), 0);  // type U
+    ASSERT_EQ(AlarmGetTopActive(&top), 0);
+    ASSERT_EQ(top.id, 0x30 | kAlarmOriginTest2);
+
+    ASSERT_EQ(AlarmSet(true, 0x01, kAlarmOriginTest1), 0);  // type B
+    ASSERT_EQ(AlarmSet(true, 0x04, kAlarmOriginTest1), 0);  // type B
+    ASSERT_EQ(AlarmGetTopActive(&top), 0);
+    ASSERT_EQ(top.id, 0x01 | kAlarmOriginTest1);
+
+    ASSERT_EQ(AlarmSet(true, 0x03, kAlarmOriginTest1), 0);  // type A
+    ASSERT_EQ(AlarmSet(true, 0x02, kAlarmOriginTest1), 0);  // type A
+    ASSERT_EQ(AlarmGetTopActive(&top), 0);
+    ASSERT_EQ(top.id, 0x03 | kAlarmOriginTest1);
+    ASSERT_TRUE(AlarmActiveTypeAAlarms());
+
+    // Acknowledged, so the type A alarms are not latched when they clear
+    ASSERT_EQ(AlarmAcknowledgeAll(), 5);
+    ASSERT_EQ(AlarmSet(false, 0x03, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmGetTopActive(&top), 0);
+    ASSERT_EQ(top.id, 0x02 | kAlarmOriginTest1);
+
+    ASSERT_EQ(AlarmSet(false, 0x02, kAlarmOriginTest1), 0);
+    ASSERT_FALSE(AlarmActiveTypeAAlarms());
+    ASSERT_EQ(AlarmSet(false, 0x01, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmGetTopActive(&top), 0);
+    ASSERT_EQ(top.id, 0x04 | kAlarmOriginTest1);
+
+    // A slot reused by a newer alarm does not make it older
+    ASSERT_EQ(AlarmSet(true, 0x05, kAlarmOriginTest1), 0);  // type B
+    ASSERT_EQ(AlarmGetTopActive(&top), 0);
+    ASSERT_EQ(top.id, 0x04 | kAlarmOriginTest1);
+
+    ASSERT_EQ(AlarmSet(false, 0x04, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmSet(false, 0x05, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmGetTopActive(&top), 0);
+    ASSERT_EQ(top.id, 0x30 | kAlarmOriginTest2);
+    ASSERT_EQ(AlarmSet(false, 0x30, kAlarmOriginTest2), 0);
+    ASSERT_EQ(AlarmGetTopActive(&top), -ENOENT);
+}
+
+TEST_F(AlarmTests, AlarmSet_UnacknowledgedTypeAAlarmIsLatched) {
+    ASSERT_EQ(AlarmSet(true, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_EQ(AlarmSet(false, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_EQ(published_.size(), 1);
+    ASSERT_FALSE(AlarmIsActive(kTypeAAlarmId, NULL));
+    ASSERT_TRUE(AlarmActiveTypeAAlarms());
+
+    ASSERT_EQ(AlarmWalk(walk_callback, NULL), 0);
+    ASSERT_EQ(alarm_walk_entries_.size(), 0);
+    ASSERT_EQ(AlarmWalkState(kAlarmStateLatched, walk_callback, NULL), 0);
+    ASSERT_EQ(alarm_walk_entries_.size(), 1);
+    ASSERT_EQ(alarm_walk_entries_.at(0).id, kTypeAAlarmId | kTypeAAlarmOrigin);
+
+    ASSERT_EQ(AlarmAcknowledge(kTypeAAlarmId | kTypeAAlarmOrigin), 0);
+    ASSERT_FALSE(AlarmActiveTypeAAlarms());
+    ASSERT_EQ(published_.size(), 2);
+    ASSERT_FALSE(published_.at(1).alarm_msg.alarm_active);
+    ASSERT_EQ(AlarmAcknowledge(kTypeAAlarmId | kTypeAAlarmOrigin), -ENOENT);
+}
+
+TEST_F(AlarmTests, AlarmSet_AcknowledgedAlarmClearsNormally) {
+    ASSERT_EQ(AlarmSet(true, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_EQ(AlarmSet(true, 1, kAlarmOriginTest1), 0);
+    ASSERT_EQ(AlarmAcknowledgeAll(), 2);
+    ASSERT_EQ(AlarmAcknowledgeAll(), 0);
+
+    ASSERT_EQ(AlarmWalkState(kAlarmStateAcknowledged, walk_callback, NULL), 0);
+    ASSERT_EQ(alarm_walk_entries_.size(), 2);
+
+    ASSERT_EQ(AlarmSet(false, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_FALSE(AlarmActiveTypeAAlarms());
+    ASSERT_EQ(published_.size(), 3);
+}
+
+TEST_F(AlarmTests, AlarmSet_LatchedAlarmRaisedAgainIsActive) {
+    ASSERT_EQ(AlarmSet(true, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_EQ(AlarmSet(false, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_EQ(AlarmSet(true, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_TRUE(AlarmIsActive(kTypeAAlarmId, NULL));
+    ASSERT_EQ(published_.size(), 1);
+
+    struct alarm_stats_t stats;
+    ASSERT_EQ(AlarmStatsGet(kTypeAAlarmId | kTypeAAlarmOrigin, &stats), 0);
+    ASSERT_EQ(stats.count, 2);
+
+    // Acknowledging an active alarm keeps it until the condition clears
+    ASSERT_EQ(AlarmAcknowledge(kTypeAAlarmId | kTypeAAlarmOrigin), 0);
+    ASSERT_TRUE(AlarmIsActive(kTypeAAlarmId, NULL));
+    ASSERT_EQ(AlarmSet(false, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_EQ(AlarmWalkState(0xFF, walk_callback, NULL), 0);
+    ASSERT_EQ(alarm_walk_entries_.size(), 0);
+}
+
+TEST_F(AlarmTests, AlarmOriginsWithError_ReportsEveryOrigin) {
+    ASSERT_EQ(AlarmSet(true, 5, kAlarmOriginVinga1), 0);
+    ASSERT_EQ(AlarmSet(true, 5, kAlarmOriginVinga4), 0);
+    ASSERT_EQ(AlarmSet(true, 6, kAlarmOriginVinga4), 0);
+    ASSERT_EQ(AlarmSet(true, 5, kAlarmOriginKoster), 0);
+
+    ASSERT_EQ(AlarmOriginsWithError(5), AlarmOriginBit(kAlarmOriginVinga1) | AlarmOriginBit(kAlarmOriginVinga4) |
+                                            AlarmOriginBit(kAlarmOriginKoster));
+    ASSERT_EQ(AlarmOriginsWithError(5), 0x13);
+    ASSERT_TRUE(AlarmIsActiveFrom(kAlarmOriginVinga4, 6));
+    ASSERT_FALSE(AlarmIsActiveFrom(kAlarmOriginVinga1, 6));
+    ASSERT_EQ(AlarmCountByOrigin(kAlarmOriginVinga4), 2);
+    ASSERT_EQ(AlarmCountByOrigin(kAlarmOriginVinga2), 0);
+
+    ASSERT_EQ(AlarmSet(false, 5, kAlarmOriginVinga4), 0);
+    ASSERT_EQ(AlarmOriginsWithError(5), AlarmOriginBit(kAlarmOriginVinga1) | AlarmOriginBit(kAlarmOriginKoster));
+    ASSERT_EQ(AlarmCountByOrigin(kAlarmOriginVinga4), 1);
+}
+
+TEST_F(AlarmTests, AlarmIsActiveFrom_LatchedAlarmIsNotActive) {
+    ASSERT_EQ(AlarmSet(true, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_TRUE(AlarmIsActiveFrom(kTypeAAlarmOrigin, kTypeAAlarmId));
+    ASSERT_EQ(AlarmSet(false, kTypeAAlarmId, kTypeAAlarmOrigin), 0);
+    ASSERT_FALSE(AlarmIsActiveFrom(kTypeAAlarmOrigin, kTypeAAlarmId));
+    ASSERT_EQ(AlarmCountByOrigin(kTypeAAlarmOrigin), 0);
+
+    // Acknowledging the latched alarm does not count it down again
+    ASSERT_EQ(AlarmAcknowledge(kTypeAAlarmId | kTypeAAlarmOrigin), 0);
+    ASSERT_EQ(AlarmCountByOrigin(kTypeAAlarmOrigin), 0);
+}
@@ -0,0 +1,262 @@
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "fff/fff.h"
+#include "koster-common/alarm.h"
+#include "koster-common/alarm_journal.h"
+#include "zephyr/kernel.h"
+#include "zephyr/storage/flash_map.h"
+
+DEFINE_FFF_GLOBALS;
+}
+
+constexpr size_t kSectorSize{256};
+constexpr size_t kSectors{4};
+constexpr size_t kBatchEvents{CONFIG_KOSTER_COMMON_ALARM_JOURNAL_BATCH_EVENTS};
+// Layout of a batch in flash: log entry header, batch header, events
+constexpr size_t kLogHeaderSize{8};
+constexpr size_t kBatchNEventsOffset{kLogHeaderSize + 8};
+constexpr uint16_t kKosterAlarm{kAlarmOriginKoster | 1};
+constexpr uint16_t kVingaAlarm{kAlarmOriginVinga1 | 1};
+
+// In-memory flash partition behind the flash_area_* fakes. Writes can only clear bits, as on NOR flash.
+struct flash_area flash_area_ = {.fa_id = 0, .fa_off = 0, .fa_size = kSectorSize * kSectors};
+std::vector<uint8_t> flash_;
+int writes_until_reset_;  // writes that succeed before flash stops responding, or -1
+
+int flash_open(uint8_t, const struct flash_area** fap) {
+    *fap = &flash_area_;
+    return 0;
+}
+
+int flash_get_sectors(int, uint32_t* cnt, struct flash_sector* sectors) {
+    sectors[0] = {.fs_off = 0, .fs_size = kSectorSize};
+    *cnt = 1;
+    return -ENOMEM;  // more sectors than fit in the array
+}
+
+int flash_read(const struct flash_area*, off_t off, void* dst, size_t len) {
+    if (off < 0 || off + len > flash_.size()) {
+        return -EINVAL;
+    }
+    memcpy(dst, &flash_[off], len);
+    return 0;
+}
+
+int flash_write(const struct flash_area*, off_t off, const void* src, size_t len) {
+    if (off < 0 || off + len > flash_.size()) {
+        return -EINVAL;
+    }
+    if (writes_until_reset_ == 0) {
+        return -EIO;
+    }
+    if (writes_until_reset_ > 0) {
+        --writes_until_reset_;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        flash_[off + i] &= static_cast<const uint8_t*>(src)[i];
+    }
+    return 0;
+}
+
+int flash_erase(const struct flash_area*, off_t off, size_t len) {
+    if (off < 0 || off + len > flash_.size()) {
+        return -EINVAL;
+    }
+    memset(&flash_[off], 0xFF, len);
+    return 0;
+}
+
+std::vector<alarm_journal_event_t> events_;
+int collect_callback(const struct alarm_journal_event_t* event, void*) {
+    events_.push_back(*event);
+    return 0;
+}
+
+int stop_callback(const struct alarm_journal_event_t* event, void*) {
+    events_.push_back(*event);
+    return 1;
+}
+
+std::vector<uint32_t> query_epochs(const uint32_t from_epoch, const uint32_t to_epoch, const uint16_t alarm_id) {
+    events_.clear();
+    const int n = AlarmJournalQuery(from_epoch, to_epoch, alarm_id, collect_callback, NULL);
+    std::vector<uint32_t> epochs;
+    for (const auto& event : events_) {
+        epochs.push_back(event.epoch);
+    }
+    EXPECT_EQ(n, static_cast<int>(epochs.size()));
+    return epochs;
+}
+
+std::vector<uint32_t> query_all() { return query_epochs(0, UINT32_MAX, 0); }
+
+class AlarmJournalTests : public testing::Test {
+  protected:
+    void SetUp() override {
+        RESET_FAKE(flash_area_open);
+        RESET_FAKE(flash_area_get_sectors);
+        RESET_FAKE(flash_area_read);
+        RESET_FAKE(flash_area_write);
+        RESET_FAKE(flash_area_erase);
+        RESET_FAKE(k_work_submit);
+        RESET_FAKE(k_work_schedule);
+        flash_area_open_fake.custom_fake = flash_open;
+        flash_area_get_sectors_fake.custom_fake = flash_get_sectors;
+        flash_area_read_fake.custom_fake = flash_read;
+        flash_area_write_fake.custom_fake = flash_write;
+        flash_area_erase_fake.custom_fake = flash_erase;
+        flash_.assign(flash_area_.fa_size, 0xFF);
+        writes_until_reset_ = -1;
+        ASSERT_EQ(AlarmJournalInit(), 0);
+    };
+
+    // The RAM buffer is lost and the journal is read back from flash, as after a reset
+    void reboot() { ASSERT_EQ(AlarmJournalInit(), 0); }
+
+    void flush_batch(const std::vector<uint32_t>& epochs) {
+        for (const auto epoch : epochs) {
+            ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, epoch), 0);
+        }
+        ASSERT_EQ(AlarmJournalFlush(), 0);
+    }
+};
+
+TEST_F(AlarmJournalTests, Init_SchedulesPeriodicFlush) { ASSERT_EQ(k_work_schedule_fake.call_count, 1u); }
+
+TEST_F(AlarmJournalTests, Record_DoesNotWriteFlash) {
+    ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, 10), 0);
+    ASSERT_EQ(AlarmJournalRecord(false, kKosterAlarm, 20), 0);
+
+    ASSERT_EQ(flash_area_erase_fake.call_count, 0u);
+    ASSERT_EQ(flash_area_write_fake.call_count, 0u);
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{10, 20}));
+    ASSERT_EQ(events_[0].alarm_id, kKosterAlarm);
+    ASSERT_EQ(events_[0].active, 1);
+    ASSERT_EQ(events_[1].active, 0);
+}
+
+TEST_F(AlarmJournalTests, Flush_WritesBufferedEventsAsOneBatch) {
+    flush_batch({10, 20, 30});
+
+    ASSERT_EQ(flash_area_erase_fake.call_count, 1u);
+    ASSERT_EQ(flash_area_erase_fake.arg2_val, kSectorSize);
+    ASSERT_EQ(flash_area_write_fake.call_count, 2u);  // events, then the log entry header
+    reboot();
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{10, 20, 30}));
+    ASSERT_EQ(events_[2].alarm_id, kKosterAlarm);
+}
+
+TEST_F(AlarmJournalTests, Flush_NothingBuffered_DoesNotWrite) {
+    ASSERT_EQ(AlarmJournalFlush(), 0);
+
+    ASSERT_EQ(flash_area_erase_fake.call_count, 0u);
+    ASSERT_EQ(flash_area_write_fake.call_count, 0u);
+}
+
+TEST_F(AlarmJournalTests, Record_BufferFull_SubmitsFlushAndDropsEvents) {
+    for (size_t i = 0; i < kBatchEvents - 1; ++i) {
+        ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, i), 0);
+    }
+    ASSERT_EQ(k_work_submit_fake.call_count, 0u);
+
+    ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, kBatchEvents - 1), 0);
+    ASSERT_EQ(k_work_submit_fake.call_count, 1u);
+    ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, kBatchEvents), -ENOMEM);
+
+    ASSERT_EQ(AlarmJournalFlush(), 0);
+    ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, kBatchEvents + 1), 0);
+    reboot();
+    ASSERT_EQ(query_all().size(), kBatchEvents);
+    ASSERT_EQ(events_.back().epoch, kBatchEvents - 1);
+}
+
+TEST_F(AlarmJournalTests, Flush_PartitionFull_OverwritesOldestBatch) {
+    for (uint32_t epoch = 100; epoch < 100 + kSectors + 2; ++epoch) {
+        flush_batch({epoch});
+    }
+
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{102, 103, 104, 105}));
+    reboot();
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{102, 103, 104, 105}));
+
+    // Writing continues after the newest batch found in flash
+    flush_batch({106});
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{103, 104, 105, 106}));
+}
+
+TEST_F(AlarmJournalTests, Query_SkipsPartiallyWrittenBatch) {
+    flush_batch({10});
+    ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, 20), 0);
+    // Only the first of the two writes of the batch reaches flash
+    writes_until_reset_ = 1;
+    ASSERT_EQ(AlarmJournalFlush(), -EIO);
+    writes_until_reset_ = -1;
+
+    reboot();
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{10}));
+
+    flush_batch({30});
+    reboot();
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{10, 30}));
+}
+
+TEST_F(AlarmJournalTests, Query_SkipsBatchWithCorruptMagic) {
+    flush_batch({10});
+    flush_batch({20});
+    flash_[0] ^= 0xFF;
+
+    reboot();
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{20}));
+}
+
+TEST_F(AlarmJournalTests, Query_SkipsBatchWithInconsistentHeader) {
+    flush_batch({10, 11});
+    flush_batch({20});
+    flash_[kBatchNEventsOffset] = 7;
+
+    reboot();
+    ASSERT_EQ(query_all(), (std::vector<uint32_t>{20}));
+}
+
+TEST_F(AlarmJournalTests, Query_FiltersByAlarmIdAndTime) {
+    ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, 10), 0);
+    ASSERT_EQ(AlarmJournalRecord(true, kVingaAlarm, 20), 0);
+    ASSERT_EQ(AlarmJournalRecord(false, kKosterAlarm, 30), 0);
+    ASSERT_EQ(AlarmJournalFlush(), 0);
+    // These stay in the RAM buffer
+    ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, 40), 0);
+    ASSERT_EQ(AlarmJournalRecord(false, kVingaAlarm, 50), 0);
+
+    ASSERT_EQ(query_epochs(0, UINT32_MAX, kKosterAlarm), (std::vector<uint32_t>{10, 30, 40}));
+    ASSERT_EQ(query_epochs(0, UINT32_MAX, kVingaAlarm), (std::vector<uint32_t>{20, 50}));
+    ASSERT_EQ(query_epochs(15, 45, 0), (std::vector<uint32_t>{20, 30, 40}));
+    ASSERT_EQ(query_epochs(15, 45, kVingaAlarm), (std::vector<uint32_t>{20}));
+    ASSERT_EQ(query_epochs(31, 39, 0), (std::vector<uint32_t>{}));
+}
+
+TEST_F(AlarmJournalTests, Query_BatchOutsideTimeRange_ReadsOnlyItsHeader) {
+    flush_batch({10, 11, 12});
+    flush_batch({20, 21});
+    reboot();
+
+    RESET_FAKE(flash_area_read);
+    flash_area_read_fake.custom_fake = flash_read;
+    ASSERT_EQ(query_epochs(20, 30, 0), (std::vector<uint32_t>{20, 21}));
+
+    // One log entry header per slot, one batch header per batch and the events of the matching batch
+    ASSERT_EQ(flash_area_read_fake.call_count, kSectors + 2 + 1);
+}
+
+TEST_F(AlarmJournalTests, Query_CallbackReturnsNonZero_Stops) {
+    flush_batch({10, 20});
+    ASSERT_EQ(AlarmJournalRecord(true, kKosterAlarm, 30), 0);
+
+    events_.clear();
+    ASSERT_EQ(AlarmJournalQuery(0, UINT32_MAX, 0, stop_callback, NULL), 1);
+    ASSERT_EQ(events_.size(), 1u);
+    ASSERT_EQ(events_[0].epoch, 10u);
+}
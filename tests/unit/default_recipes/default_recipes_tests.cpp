@@ -7,10 +7,13 @@ extern "C" {
 #include "default_recipes.h"
 #include "default_recipes_generated.h"
 #include "fff/fff.h"
-#include "parameters.h"
+#include "koster-common/koster-zbus.h"
+#include "koster-common/parameters.h"
 #include "recipe_types.h"
 
 DEFINE_FFF_GLOBALS;
+
+const struct zbus_channel kzbus_param_chan;
 }
 
 class DefaultRecipeTests : public testing::Test {
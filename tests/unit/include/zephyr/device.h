@@ -0,0 +1,3 @@
+#pragma once
+
+#define DT_HAS_CHOSEN(node) 0
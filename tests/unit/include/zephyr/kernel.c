@@ -9,3 +9,11 @@ DEFINE_FAKE_VOID_FUNC(z_log_minimal_printk);
 DEFINE_FAKE_VOID_FUNC(log_const_app);
 
 DEFINE_FAKE_VALUE_FUNC(uint32_t, k_uptime_seconds);
+DEFINE_FAKE_VALUE_FUNC(int64_t, k_uptime_get);
+
+DEFINE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *, k_work_handler_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_schedule, struct k_work_delayable *, k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *, k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable, struct k_work_delayable *);
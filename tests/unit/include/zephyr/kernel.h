@@ -6,7 +6,13 @@
 #include "fff/fff.h"
 
 #define K_MSEC(X) X
+#define K_SECONDS(X) ((X) * 1000)
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define ROUND_UP(x, align) ((((x) + (align) - 1) / (align)) * (align))
+#define ARG_UNUSED(x) (void)(x)
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#define __packed __attribute__((__packed__))
 #define K_FOREVER 0
 #define K_NO_WAIT 0
 
@@ -15,6 +21,15 @@ struct k_mutex {
 };
 typedef int k_timeout_t;
 
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+struct k_work {
+    k_work_handler_t handler;
+};
+struct k_work_delayable {
+    struct k_work work;
+};
+
 DECLARE_FAKE_VALUE_FUNC(int, k_mutex_lock, struct k_mutex *, k_timeout_t);
 DECLARE_FAKE_VOID_FUNC(k_mutex_unlock, struct k_mutex *);
 DECLARE_FAKE_VALUE_FUNC(int, k_mutex_init, struct k_mutex *);
@@ -24,3 +39,11 @@ DECLARE_FAKE_VOID_FUNC(z_log_minimal_printk);
 DECLARE_FAKE_VOID_FUNC(log_const_app);
 
 DECLARE_FAKE_VALUE_FUNC(uint32_t, k_uptime_seconds);
+DECLARE_FAKE_VALUE_FUNC(int64_t, k_uptime_get);
+
+DECLARE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+DECLARE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *, k_work_handler_t);
+DECLARE_FAKE_VALUE_FUNC(int, k_work_schedule, struct k_work_delayable *, k_timeout_t);
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *, k_timeout_t);
+DECLARE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable, struct k_work_delayable *);
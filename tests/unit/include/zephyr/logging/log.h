@@ -16,3 +16,12 @@
         printf(__VA_ARGS__); \
         puts("");            \
     } while (0)
+#define LOG_WRN(...)         \
+    do {                     \
+        printf("WRN: ");     \
+        printf(__VA_ARGS__); \
+        puts("");            \
+    } while (0)
+#define LOG_DBG(...) \
+    do {             \
+    } while (0)
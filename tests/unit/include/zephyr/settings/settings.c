@@ -2,5 +2,7 @@
 
 DEFINE_FAKE_VALUE_FUNC(int, settings_subsys_init);
 DEFINE_FAKE_VALUE_FUNC(int, settings_load);
+DEFINE_FAKE_VALUE_FUNC(int, settings_load_subtree, const char *);
 DEFINE_FAKE_VALUE_FUNC(int, settings_register, struct settings_handler *);
 DEFINE_FAKE_VALUE_FUNC(int, settings_save_one, const char *, const void *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, settings_delete, const char *);
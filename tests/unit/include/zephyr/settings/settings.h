@@ -18,5 +18,7 @@ struct settings_handler {
 
 DECLARE_FAKE_VALUE_FUNC(int, settings_subsys_init);
 DECLARE_FAKE_VALUE_FUNC(int, settings_load);
+DECLARE_FAKE_VALUE_FUNC(int, settings_load_subtree, const char *);
 DECLARE_FAKE_VALUE_FUNC(int, settings_register, struct settings_handler *);
 DECLARE_FAKE_VALUE_FUNC(int, settings_save_one, const char *, const void *, size_t);
+DECLARE_FAKE_VALUE_FUNC(int, settings_delete, const char *);
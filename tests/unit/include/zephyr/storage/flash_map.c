@@ -0,0 +1,7 @@
+#include "flash_map.h"
+
+DEFINE_FAKE_VALUE_FUNC(int, flash_area_open, uint8_t, const struct flash_area **);
+DEFINE_FAKE_VALUE_FUNC(int, flash_area_get_sectors, int, uint32_t *, struct flash_sector *);
+DEFINE_FAKE_VALUE_FUNC(int, flash_area_read, const struct flash_area *, off_t, void *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, flash_area_write, const struct flash_area *, off_t, const void *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, flash_area_erase, const struct flash_area *, off_t, size_t);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "fff/fff.h"
+
+#define FIXED_PARTITION_ID(label) 0
+
+struct flash_area {
+    uint8_t fa_id;
+    off_t fa_off;
+    size_t fa_size;
+};
+
+struct flash_sector {
+    off_t fs_off;
+    size_t fs_size;
+};
+
+DECLARE_FAKE_VALUE_FUNC(int, flash_area_open, uint8_t, const struct flash_area **);
+DECLARE_FAKE_VALUE_FUNC(int, flash_area_get_sectors, int, uint32_t *, struct flash_sector *);
+DECLARE_FAKE_VALUE_FUNC(int, flash_area_read, const struct flash_area *, off_t, void *, size_t);
+DECLARE_FAKE_VALUE_FUNC(int, flash_area_write, const struct flash_area *, off_t, const void *, size_t);
+DECLARE_FAKE_VALUE_FUNC(int, flash_area_erase, const struct flash_area *, off_t, size_t);
@@ -0,0 +1,3 @@
+#pragma once
+
+static inline void barrier_dmem_fence_full(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
@@ -1,3 +1,4 @@
 #include "zephyr/zbus/zbus.h"
 
 DEFINE_FAKE_VALUE_FUNC(int, zbus_chan_pub, const struct zbus_channel *, const void *, k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(const void *, zbus_chan_const_msg, const struct zbus_channel *);
@@ -5,6 +5,15 @@
 
 struct zbus_channel {};
 
-#define ZBUS_CHAN_DECLARE(_name, ...) struct zbus_channel _name
+#define ZBUS_CHAN_DECLARE(...) extern const struct zbus_channel __VA_ARGS__
 
 DECLARE_FAKE_VALUE_FUNC(int, zbus_chan_pub, const struct zbus_channel *, const void *, k_timeout_t);
+
+struct zbus_observer {
+    void (*callback)(const struct zbus_channel *chan);
+};
+
+#define ZBUS_LISTENER_DEFINE(_name, _cb) const struct zbus_observer _name = {_cb}
+#define ZBUS_CHAN_ADD_OBS(_chan, _obs, _prio)
+
+DECLARE_FAKE_VALUE_FUNC(const void *, zbus_chan_const_msg, const struct zbus_channel *);
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "fff/fff.h"
+#include "koster-common/koster-zbus.h"
+#include "koster-common/parameters.h"
+#include "zephyr/kernel.h"
+#include "zephyr/settings/settings.h"
+
+const struct zbus_channel kzbus_param_chan = {};
+}
+
+DEFINE_FFF_GLOBALS;
+
+static std::vector<uint8_t> saved_blob_;
+
+static int save_blob(const char*, const void* value, size_t len) {
+    const uint8_t* data = static_cast<const uint8_t*>(value);
+    saved_blob_.assign(data, data + len);
+    return 0;
+}
+
+static int name_next(const char* name, const char** next) {
+    *next = NULL;
+    return strlen(name);
+}
+
+static ssize_t read_buffer(void* cb_arg, void* data, size_t len) {
+    memcpy(data, cb_arg, len);
+    return len;
+}
+
+class ParametersBlobTests : public testing::Test {
+  protected:
+    void SetUp() override {
+        RESET_FAKE(settings_save_one);
+        RESET_FAKE(settings_delete);
+        RESET_FAKE(settings_register);
+        settings_save_one_fake.custom_fake = save_blob;
+        settings_name_next_fake.custom_fake = name_next;
+        ParamInit();
+        handler_ = settings_register_fake.arg0_val;
+    };
+    void TearDown() override { settings_name_next_fake.custom_fake = NULL; }
+
+    int LoadBlob(std::vector<uint8_t> blob) { return handler_->h_set("blob", blob.size(), read_buffer, blob.data()); }
+    int LoadKey(const char* name, int32_t value) { return handler_->h_set(name, sizeof(value), read_buffer, &value); }
+
+    struct settings_handler* handler_;
+};
+
+TEST_F(ParametersBlobTests, Flush_SavesOneEntry) {
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    ASSERT_EQ(ParamSetUint8param(150), 0);
+    ASSERT_EQ(ParamFlush(), 2);
+    ASSERT_EQ(settings_save_one_fake.call_count, 1);
+    ASSERT_STREQ(settings_save_one_fake.arg0_val, "parameters/blob");
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+
+    // Header, a 3 byte layout entry per parameter, and the values in the width of their type
+    ASSERT_EQ(saved_blob_.size(), 6u + 3 * PARAM_NUM_PARAMS + 1 + 1 + 1 + 4 + 4);
+    ASSERT_EQ(settings_delete_fake.call_count, 0);
+}
+
+TEST_F(ParametersBlobTests, Load_RestoresValues) {
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    ASSERT_EQ(ParamSetEnumparam(kParamValue2), 0);
+    ASSERT_EQ(ParamFlush(), 2);
+    const std::vector<uint8_t> blob = saved_blob_;
+
+    ParamInit();
+    ASSERT_EQ(ParamGetInt32param(), 1337000);
+    ASSERT_EQ(LoadBlob(blob), 0);
+    ASSERT_EQ(ParamGetInt32param(), 1500000);
+    ASSERT_EQ(ParamGetEnumparam(), kParamValue2);
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+}
+
+TEST_F(ParametersBlobTests, Load_MigratesSingleEntries) {
+    ASSERT_EQ(LoadKey("Int32param", 1500000), 0);
+    ASSERT_EQ(ParamGetInt32param(), 1500000);
+    ASSERT_TRUE(ParamHasUnsavedChanges());
+
+    ASSERT_EQ(ParamFlush(), 1);
+    ASSERT_STREQ(settings_save_one_fake.arg0_val, "parameters/blob");
+    ASSERT_EQ(settings_delete_fake.call_count, PARAM_NUM_PARAMS);
+
+    // Deleted once
+    ASSERT_EQ(ParamSetInt32param(1600000), 0);
+    ASSERT_EQ(ParamFlush(), 1);
+    ASSERT_EQ(settings_delete_fake.call_count, PARAM_NUM_PARAMS);
+}
+
+TEST_F(ParametersBlobTests, Load_BlobWinsOverSingleEntries) {
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    ASSERT_EQ(ParamFlush(), 1);
+    const std::vector<uint8_t> blob = saved_blob_;
+    ParamInit();
+
+    // Entries left from before the blob was saved, in either order
+    ASSERT_EQ(LoadKey("Int32param", 1200000), 0);
+    ASSERT_EQ(LoadBlob(blob), 0);
+    ASSERT_EQ(LoadKey("Int32param", 1300000), 0);
+    ASSERT_EQ(ParamGetInt32param(), 1500000);
+}
+
+TEST_F(ParametersBlobTests, Load_OtherSchemaById) {
+    // Int32param (Id 2) as int16_t, UInt8Param (Id 10), and a removed parameter (Id 99)
+    const std::vector<uint8_t> blob = {
+        0x78, 0x56, 0x34, 0x12,  // schema hash
+        3,    0,                 // number of fields
+        2,    0,    0x82,        // Id 2, int16_t
+        10,   0,    0x01,        // Id 10, uint8_t
+        99,   0,    0x04,        // Id 99, uint32_t
+        0x40, 0x42,              // 16960
+        150,                     //
+        1,    2,    3,    4,
+    };
+    ASSERT_EQ(ParamSetInt32param(1100000), 0);
+    ASSERT_EQ(ParamFlush(), 1);
+
+    ASSERT_EQ(LoadBlob(blob), 0);
+    ASSERT_EQ(ParamGetInt32param(), 1100000);  // 16960 is out of range
+    ASSERT_EQ(ParamGetUint8param(), 150);
+    // Saved again in the current schema
+    ASSERT_TRUE(ParamHasUnsavedChanges());
+
+    const std::vector<uint8_t> negative = {
+        0, 0, 0, 0, 1, 0, 3, 0, 0x81, 0xFF,  // Id 3, int8_t -1
+    };
+    ASSERT_EQ(LoadBlob(negative), 0);
+    ASSERT_EQ(ParamGetUnused(), 0);  // -1 is out of range
+}
+
+TEST_F(ParametersBlobTests, Load_RejectsTruncatedBlob) {
+    const std::vector<uint8_t> blob = {0, 0, 0, 0, 2, 0, 2, 0, 0x84, 1, 2, 3, 4};
+    ASSERT_EQ(LoadBlob(blob), -EINVAL);
+    ASSERT_EQ(LoadBlob({0, 0, 0}), -EINVAL);
+    ASSERT_EQ(ParamGetInt32param(), 1337000);
+}
@@ -1,30 +1,70 @@
 #include "gtest/gtest.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 extern "C" {
 #include "fff/fff.h"
+#include "koster-common/koster-zbus.h"
 #include "koster-common/parameters.h"
+#include "parameters_private.h"
+#include "zephyr/kernel.h"
+#include "zephyr/settings/settings.h"
+
+const struct zbus_channel kzbus_control_chan = {};
+const struct zbus_channel kzbus_param_chan = {};
+extern const struct zbus_observer param_write_behind_listener;
+extern struct k_mutex param_mutex;
 }
 
 DEFINE_FFF_GLOBALS;
 
+static int name_next(const char* name, const char** next) {
+    *next = NULL;
+    return strlen(name);
+}
+
+static struct kzbus_msg_t published_;
+
+static int capture_published(const struct zbus_channel*, const void* msg, k_timeout_t) {
+    memcpy(&published_, msg, sizeof(published_));
+    return 0;
+}
+
+static ssize_t read_int32(void* cb_arg, void* data, size_t len) {
+    memcpy(data, cb_arg, len);
+    return len;
+}
+
 class ParametersTests : public testing::Test {
   protected:
-    void SetUp() override { ParamInit(); };
+    void SetUp() override {
+        RESET_FAKE(settings_save_one);
+        RESET_FAKE(settings_register);
+        RESET_FAKE(k_work_init_delayable);
+        RESET_FAKE(k_work_reschedule);
+        RESET_FAKE(k_work_schedule);
+        RESET_FAKE(zbus_chan_const_msg);
+        RESET_FAKE(zbus_chan_pub);
+        zbus_chan_pub_fake.custom_fake = capture_published;
+        ParamInit();
+    };
     void GetEnumParam(const struct param_t** param) {
         const struct param_category_t* category;
         ASSERT_EQ(ParamGetCategory(&category, 2), 0);  // Cat Stevens
-        ASSERT_EQ(ParamCategoryGetNParams(category), 2);
+        ASSERT_EQ(ParamCategoryGetNParams(category, PARAM_ACCESS_LEVELS - 1), 2);
         ASSERT_EQ(ParamCategoryGetParam(category, param, 0), 0);  // EnumParam
     }
     void GetInt32Param(const struct param_t** param) {
         const struct param_category_t* category;
         ASSERT_EQ(ParamGetCategory(&category, 1), 0);  // B
-        ASSERT_EQ(ParamCategoryGetNParams(category), 2);
+        ASSERT_EQ(ParamCategoryGetNParams(category, PARAM_ACCESS_LEVELS - 1), 2);
         ASSERT_EQ(ParamCategoryGetParam(category, param, 0), 0);  // Int32Param
     }
     void GetUInt8Param(const struct param_t** param) {
         const struct param_category_t* category;
         ASSERT_EQ(ParamGetCategory(&category, 0), 0);  // Ape
-        ASSERT_EQ(ParamCategoryGetNParams(category), 1);
+        ASSERT_EQ(ParamCategoryGetNParams(category, PARAM_ACCESS_LEVELS - 1), 1);
         ASSERT_EQ(ParamCategoryGetParam(category, param, 0), 0);  // UInt8Param
     }
 };
@@ -42,6 +82,19 @@ TEST_F(ParametersTests, LoadMachineTypeDefaults) {
     ParamLoadDefaults(kParamType3);
     ASSERT_EQ(ParamGetEnumparam(), kParamValue0);
     ASSERT_EQ(ParamGetInt32param(), 2000000);
+
+    // Without overrides
+    ParamLoadDefaults(kParamType1);
+    ASSERT_EQ(ParamGetMachineType(), kParamType1);
+    ASSERT_EQ(ParamGetEnumparam(), kParamValue1);
+    ASSERT_EQ(ParamGetInt32param(), 1337000);
+
+    // Unknown machine type
+    ParamLoadDefaults(kParamType3);
+    ParamLoadDefaults(kParamN_machine_type_t);
+    ASSERT_EQ(ParamGetMachineType(), kParamType1);
+    ASSERT_EQ(ParamGetEnumparam(), kParamValue1);
+    ASSERT_EQ(ParamGetInt32param(), 1337000);
 }
 
 TEST_F(ParametersTests, GetSetUInt8ParamByName) {
@@ -87,7 +140,7 @@ TEST_F(ParametersTests, GetSetEnumParamByName) {
 TEST_F(ParametersTests, GetSetUInt8ParamFromCategory) {
     const struct param_category_t* category;
     ASSERT_EQ(ParamGetCategory(&category, 0), 0);  // Ape
-    ASSERT_EQ(ParamCategoryGetNParams(category), 1);
+    ASSERT_EQ(ParamCategoryGetNParams(category, PARAM_ACCESS_LEVELS - 1), 1);
     const struct param_t* param;
     ASSERT_EQ(ParamCategoryGetParam(category, &param, 0), 0);  // UInt8param
 
@@ -104,7 +157,7 @@ TEST_F(ParametersTests, GetSetUInt8ParamFromCategory) {
 TEST_F(ParametersTests, GetSetInt32ParamFromCategory) {
     const struct param_category_t* category;
     ASSERT_EQ(ParamGetCategory(&category, 1), 0);  // B
-    ASSERT_EQ(ParamCategoryGetNParams(category), 2);
+    ASSERT_EQ(ParamCategoryGetNParams(category, PARAM_ACCESS_LEVELS - 1), 2);
     const struct param_t* param;
     ASSERT_EQ(ParamCategoryGetParam(category, &param, 0), 0);  // Int32Param
 
@@ -121,7 +174,7 @@ TEST_F(ParametersTests, GetSetInt32ParamFromCategory) {
 TEST_F(ParametersTests, GetSetEnumParamFromCategory) {
     const struct param_category_t* category;
     ASSERT_EQ(ParamGetCategory(&category, 2), 0);  // Cat Stevens
-    ASSERT_EQ(ParamCategoryGetNParams(category), 2);
+    ASSERT_EQ(ParamCategoryGetNParams(category, PARAM_ACCESS_LEVELS - 1), 2);
     const struct param_t* param;
     ASSERT_EQ(ParamCategoryGetParam(category, &param, 0), 0);  // EnumParam
 
@@ -154,6 +207,19 @@ TEST_F(ParametersTests, IncreaseEnumParam_Wrap) {
     ASSERT_EQ(ParamGetEnumparam(), kParamValue0);
 }
 
+TEST_F(ParametersTests, IncreaseValue_TakesNoLock) {
+    const struct param_t* param;
+    GetInt32Param(&param);
+    RESET_FAKE(k_mutex_lock);
+    ASSERT_EQ(ParamIncreaseValue(param), 0);
+    ASSERT_EQ(ParamDecreaseValue(param), 0);
+    ASSERT_EQ(ParamDecreaseValue(param), 0);
+    ASSERT_EQ(k_mutex_lock_fake.call_count, 0);
+    ASSERT_EQ(ParamGetInt32param(), 1336999);
+    ASSERT_EQ(ParamIncreaseValue(nullptr), -1);
+    ASSERT_EQ(ParamDecreaseValue(nullptr), -1);
+}
+
 TEST_F(ParametersTests, DecreaseEnumParam) {
     ParamLoadDefaults(0);
     ASSERT_EQ(ParamGetEnumparam(), kParamValue1);
@@ -269,6 +335,53 @@ TEST_F(ParametersTests, GetValueStringInt32Param) {
     ASSERT_EQ(ParamGetValueString(param, str, 2000001), -1);
 }
 
+TEST(ParamFormatFixed, MatchesPrintf) {
+    const int32_t values[] = {0, 1, -1, 9, 10, 99, 12345, -12345, 1337000, INT32_MAX, INT32_MIN};
+    char str[32];
+    char expected[32];
+
+    for (const int32_t value : values) {
+        for (int exponent = -12; exponent <= 0; ++exponent) {
+            ASSERT_EQ(param_format_fixed(str, sizeof(str), value, exponent), 0);
+            snprintf(expected, sizeof(expected), "%.*f", -exponent, value * pow(10.0, exponent));
+            ASSERT_EQ(std::string(str), std::string(expected)) << value << "e" << exponent;
+        }
+    }
+
+    // Positive exponents are not applied
+    ASSERT_EQ(param_format_fixed(str, sizeof(str), 42, 3), 0);
+    ASSERT_EQ(std::string(str), "42");
+}
+
+TEST(ParamFormatFixed, FailsIfTooLong) {
+    char str[9];  // "-123.456"
+    ASSERT_EQ(param_format_fixed(str, sizeof(str), -123456, -3), 0);
+    ASSERT_EQ(std::string(str), "-123.456");
+    ASSERT_EQ(param_format_fixed(str, sizeof(str), 12345678, -3), -1);
+    ASSERT_EQ(param_format_fixed(str, sizeof(str), 1, -8), -1);
+}
+
+TEST_F(ParametersTests, GetUnit) {
+    const struct param_t* param;
+    GetInt32Param(&param);
+    ASSERT_STREQ(ParamGetUnit(param), "Unit1");
+    GetEnumParam(&param);
+    ASSERT_STREQ(ParamGetUnit(param), "");
+    ASSERT_STREQ(ParamGetUnit(NULL), "");
+}
+
+TEST_F(ParametersTests, GetCurrentValueString_LeavesMutexUnlocked) {
+    const struct param_t* param;
+    GetInt32Param(&param);
+    RESET_FAKE(k_mutex_lock);
+    RESET_FAKE(k_mutex_unlock);
+
+    char str[PARAM_VALUE_STRING_MAX_LEN];
+    ASSERT_EQ(ParamGetCurrentValueString(param, str), 0);
+    ASSERT_EQ(std::string(str), "1.337000");
+    ASSERT_EQ(k_mutex_lock_fake.call_count, k_mutex_unlock_fake.call_count);
+}
+
 TEST_F(ParametersTests, GetValueStringEnumParam) {
     const struct param_t* param;
     GetEnumParam(&param);
@@ -305,3 +418,506 @@ TEST_F(ParametersTests, GetCategoryName) {
     ASSERT_EQ(ParamGetCategoryName(category, name), 0);
     ASSERT_EQ(std::string(name), "Cat stevens");
 }
+
+TEST_F(ParametersTests, StringPointers) {
+    const struct param_category_t* category;
+    ASSERT_EQ(ParamGetCategory(&category, 2), 0);
+    ASSERT_STREQ(ParamCategoryNamePtr(category), "Cat stevens");
+    ASSERT_STREQ(ParamCategoryNamePtr(nullptr), "");
+
+    const struct param_t* param;
+    GetEnumParam(&param);
+    ASSERT_STREQ(ParamNamePtr(param), "EnumParam");
+    ASSERT_STREQ(ParamDescriptionPtr(param), "");
+    ASSERT_STREQ(ParamNamePtr(nullptr), "");
+    ASSERT_STREQ(ParamDescriptionPtr(nullptr), "");
+    // Same string every time, no copy
+    ASSERT_EQ(ParamNamePtr(param), ParamNamePtr(param));
+
+    ASSERT_STREQ(ParamEnumLabelPtr(param, kParamValue0), "Value0");
+    ASSERT_STREQ(ParamEnumLabelPtr(param, kParamValue2), "Value2");
+    ASSERT_EQ(ParamEnumLabelPtr(param, kParamN_enum_t), nullptr);
+    ASSERT_EQ(ParamEnumLabelPtr(param, -1), nullptr);
+
+    GetInt32Param(&param);
+    ASSERT_EQ(ParamEnumLabelPtr(param, 1500000), nullptr);
+}
+
+TEST_F(ParametersTests, EnumOptions) {
+    const struct param_t* param;
+    GetEnumParam(&param);
+    ASSERT_STREQ(ParamGetEnumOptions(param), "Value0\nValue1\nValue2");
+    ASSERT_EQ(ParamGetEnumOptions(param), ParamGetEnumOptions(param));
+
+    int32_t value;
+    ASSERT_EQ(ParamEnumValueToRow(param, kParamValue2), 2);
+    ASSERT_EQ(ParamEnumRowToValue(param, 1, &value), 0);
+    ASSERT_EQ(value, kParamValue1);
+    ASSERT_EQ(ParamEnumValueToRow(param, kParamN_enum_t), -1);
+    ASSERT_EQ(ParamEnumRowToValue(param, 3, &value), -1);
+
+    GetInt32Param(&param);
+    ASSERT_EQ(ParamGetEnumOptions(param), nullptr);
+    ASSERT_EQ(ParamEnumValueToRow(param, 1500000), -1);
+    ASSERT_EQ(ParamEnumRowToValue(param, 0, &value), -1);
+}
+
+static int collect_row(const struct param_row* row, void* arg) {
+    static_cast<std::vector<struct param_row>*>(arg)->push_back(*row);
+    return 0;
+}
+
+TEST_F(ParametersTests, RowWalk_FillsRows) {
+    const struct param_category_t* category;
+    ASSERT_EQ(ParamGetCategory(&category, 1), 0);  // B
+    RESET_FAKE(k_mutex_lock);
+    RESET_FAKE(k_mutex_unlock);
+
+    std::vector<struct param_row> rows;
+    ASSERT_EQ(ParamRowWalk(collect_row, category, PARAM_ACCESS_LEVELS - 1, &rows), 0);
+    ASSERT_EQ(k_mutex_lock_fake.call_count, 1);
+    ASSERT_EQ(k_mutex_unlock_fake.call_count, 1);
+    ASSERT_EQ(rows.size(), 2u);
+
+    const struct param_t* param;
+    GetInt32Param(&param);
+    ASSERT_EQ(rows[0].param, param);
+    ASSERT_STREQ(rows[0].name, "Int32Param");
+    ASSERT_STREQ(rows[0].unit, "Unit1");
+    ASSERT_EQ(rows[0].value, 1337000);
+    ASSERT_STREQ(rows[0].value_string, "1.337000");
+    ASSERT_EQ(rows[0].min, 1000000);
+    ASSERT_EQ(rows[0].max, 2000000);
+    ASSERT_EQ(rows[0].exponent, -6);
+    ASSERT_FALSE(rows[0].is_enum);
+    ASSERT_STREQ(rows[1].name, "Unused");
+
+    ASSERT_EQ(ParamGetCategory(&category, 2), 0);  // Cat Stevens
+    rows.clear();
+    ASSERT_EQ(ParamRowWalk(collect_row, category, 0, &rows), 0);
+    ASSERT_EQ(rows.size(), 2u);
+    ASSERT_STREQ(rows[0].name, "EnumParam");
+    ASSERT_STREQ(rows[0].value_string, "Value1");
+    ASSERT_TRUE(rows[0].is_enum);
+
+    ASSERT_EQ(ParamRowWalk(collect_row, category, PARAM_ACCESS_LEVELS, &rows), -EINVAL);
+    ASSERT_EQ(ParamRowWalk(collect_row, nullptr, 0, &rows), -EINVAL);
+}
+
+TEST_F(ParametersTests, SetLanguage) {
+    ASSERT_EQ(PARAM_NUM_LANGUAGES, 2);
+    ASSERT_EQ(ParamSelectLanguage(PARAM_NUM_LANGUAGES), -1);
+
+    const struct param_t* enum_param;
+    GetEnumParam(&enum_param);
+    const struct param_t* uint8_param;
+    GetUInt8Param(&uint8_param);
+    const char* english_name = ParamNamePtr(enum_param);
+
+    ASSERT_EQ(ParamSelectLanguage(kParamLangSE), 0);
+    ASSERT_STREQ(ParamNamePtr(enum_param), "Uppräkningsparameter");
+    ASSERT_STREQ(ParamDescriptionPtr(enum_param), "Väljer ett värde");
+    char name[PARAM_NAME_MAX_LEN];
+    ASSERT_EQ(ParamGetName(enum_param, name), 0);
+    ASSERT_STREQ(name, "Uppräkningsparameter");
+    // No translation, stays English
+    ASSERT_STREQ(ParamNamePtr(uint8_param), "UInt8Param");
+
+    const struct param_category_t* category;
+    ASSERT_EQ(ParamGetCategory(&category, 2), 0);  // Cat Stevens
+    std::vector<struct param_row> rows;
+    ASSERT_EQ(ParamRowWalk(collect_row, category, PARAM_ACCESS_LEVELS - 1, &rows), 0);
+    ASSERT_EQ(rows.size(), 2u);
+    ASSERT_STREQ(rows[0].name, "Uppräkningsparameter");
+
+    // Pointers taken before the switch stay valid
+    ASSERT_STREQ(english_name, "EnumParam");
+    ASSERT_EQ(ParamSelectLanguage(kParamLangEN), 0);
+    ASSERT_STREQ(ParamNamePtr(enum_param), "EnumParam");
+    ASSERT_STREQ(ParamDescriptionPtr(enum_param), "");
+}
+
+TEST_F(ParametersTests, LoadSettingsByName) {
+    settings_name_next_fake.custom_fake = name_next;
+    struct settings_handler* handler = settings_register_fake.arg0_val;
+    int32_t value = 1500000;
+
+    ASSERT_EQ(handler->h_set("Int32param", sizeof(value), read_int32, &value), 0);
+    ASSERT_EQ(ParamGetInt32param(), 1500000);
+    value = 150;
+    ASSERT_EQ(handler->h_set("Uint8param", sizeof(value), read_int32, &value), 0);
+    ASSERT_EQ(ParamGetUint8param(), 150);
+
+    // Only whole names match
+    ASSERT_EQ(handler->h_set("Int32", sizeof(value), read_int32, &value), -ENOENT);
+    ASSERT_EQ(handler->h_set("Int32paramX", sizeof(value), read_int32, &value), -ENOENT);
+    ASSERT_EQ(handler->h_set("Aaa", sizeof(value), read_int32, &value), -ENOENT);
+    ASSERT_EQ(handler->h_set("Zzz", sizeof(value), read_int32, &value), -ENOENT);
+    ASSERT_EQ(handler->h_set("Int32param", sizeof(uint8_t), read_int32, &value), -EINVAL);
+    ASSERT_EQ(ParamGetInt32param(), 1500000);
+
+    // Values are kept in their declared type, out of range values are not loaded
+    value = 256 + 150;
+    ASSERT_EQ(handler->h_set("Uint8param", sizeof(value), read_int32, &value), 0);
+    ASSERT_EQ(ParamGetUint8param(), 150);
+    settings_name_next_fake.custom_fake = NULL;
+}
+
+TEST_F(ParametersTests, FindById) {
+    const struct param_t* param;
+    GetUInt8Param(&param);
+    ASSERT_EQ(ParamFindById(10), param);
+    ASSERT_EQ(ParamGetId(ParamFindById(2)), 2);
+    ASSERT_EQ(ParamFindById(4), nullptr);  // unused Id
+    ASSERT_EQ(ParamFindById(-1), nullptr);
+    ASSERT_EQ(ParamFindById(PARAM_MAX_ID + 1), nullptr);
+}
+
+TEST_F(ParametersTests, GetSetById) {
+    int32_t value;
+    ASSERT_EQ(ParamGetById(10, &value), 0);
+    ASSERT_EQ(value, 123);
+
+    ASSERT_EQ(ParamSetById(10, 150), 0);
+    ASSERT_EQ(ParamGetUint8param(), 150);
+    ASSERT_EQ(ParamSetById(10, 99), -1);
+    ASSERT_EQ(ParamGetUint8param(), 150);
+
+    ASSERT_EQ(ParamGetById(4, &value), -1);
+    ASSERT_EQ(ParamSetById(4, 0), -1);
+}
+
+TEST_F(ParametersTests, Tx_CommitAppliesAllUnderOneLock) {
+    const struct param_t* param;
+    GetEnumParam(&param);
+    struct param_tx tx;
+    ParamTxBegin(&tx);
+    ASSERT_EQ(ParamTxSetUint8param(&tx, 150), 0);
+    ASSERT_EQ(ParamTxSetInt32param(&tx, 1500000), 0);
+    ASSERT_EQ(ParamTxSet(&tx, param, kParamValue2), 0);
+    ASSERT_EQ(ParamGetUint8param(), 123);
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+
+    RESET_FAKE(k_mutex_lock);
+    RESET_FAKE(k_mutex_unlock);
+    ASSERT_EQ(ParamTxCommit(&tx), 0);
+    ASSERT_EQ(k_mutex_lock_fake.call_count, 1);
+    ASSERT_EQ(k_mutex_unlock_fake.call_count, 1);
+    ASSERT_EQ(ParamGetUint8param(), 150);
+    ASSERT_EQ(ParamGetInt32param(), 1500000);
+    ASSERT_EQ(ParamGetEnumparam(), kParamValue2);
+
+    // One write-behind flush saves them all
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 1);
+    ASSERT_EQ(ParamFlush(), 3);
+
+    // Empty after the commit
+    ASSERT_EQ(ParamTxCommit(&tx), 0);
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 1);
+}
+
+TEST_F(ParametersTests, Tx_FailedSetAppliesNothing) {
+    struct param_tx tx;
+    ParamTxBegin(&tx);
+    ASSERT_EQ(ParamTxSetUint8param(&tx, 150), 0);
+    ASSERT_EQ(ParamTxSetInt32param(&tx, 999999), -1);
+    ASSERT_EQ(ParamTxCommit(&tx), -1);
+    ASSERT_EQ(ParamGetUint8param(), 123);
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+
+    // Too many changes
+    ParamTxBegin(&tx);
+    for (int i = 0; i < PARAM_TX_MAX_CHANGES; ++i) {
+        ASSERT_EQ(ParamTxSetUint8param(&tx, 100 + i), 0);
+    }
+    ASSERT_EQ(ParamTxSetUint8param(&tx, 150), -1);
+    ASSERT_EQ(ParamTxCommit(&tx), -1);
+    ASSERT_EQ(ParamGetUint8param(), 123);
+}
+
+TEST_F(ParametersTests, Tx_ApplyLeavesNothingUnsaved) {
+    struct param_tx tx;
+    ParamTxBegin(&tx);
+    ASSERT_EQ(ParamTxSetUint8param(&tx, 150), 0);
+    ASSERT_EQ(ParamTxSetInt32param(&tx, 1500000), 0);
+    ASSERT_EQ(ParamTxApply(&tx), 0);
+    ASSERT_EQ(ParamGetUint8param(), 150);
+    ASSERT_EQ(ParamGetInt32param(), 1500000);
+
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 0);
+    ASSERT_EQ(ParamFlush(), 0);
+    // Still published
+    ASSERT_GT(k_work_schedule_fake.call_count, 0u);
+
+    ParamTxBegin(&tx);
+    ASSERT_EQ(ParamTxSetUint8param(&tx, 99), -1);
+    ASSERT_EQ(ParamTxApply(&tx), -1);
+    ASSERT_EQ(ParamGetUint8param(), 150);
+}
+
+TEST_F(ParametersTests, ReadRetry_AfterTx) {
+    unsigned int seq = ParamReadBegin();
+    ASSERT_FALSE(ParamReadRetry(seq));
+    ASSERT_EQ(ParamSetUint8param(150), 0);  // one value cannot be read half updated
+    ASSERT_FALSE(ParamReadRetry(seq));
+
+    struct param_tx tx;
+    ParamTxBegin(&tx);
+    ASSERT_EQ(ParamTxSetUint8param(&tx, 160), 0);
+    ASSERT_EQ(ParamTxCommit(&tx), 0);
+    ASSERT_TRUE(ParamReadRetry(seq));
+
+    seq = ParamReadBegin();
+    ParamLoadDefaults(kParamType2);
+    ASSERT_TRUE(ParamReadRetry(seq));
+    ASSERT_FALSE(ParamReadRetry(ParamReadBegin()));
+}
+
+TEST_F(ParametersTests, Snapshot_CopiesAllValues) {
+    struct param_snapshot first;
+    ASSERT_EQ(ParamSnapshot(&first), 0);
+    ASSERT_EQ(first.values[0], kParamType1);
+    ASSERT_EQ(first.values[2], 123);
+    ASSERT_EQ(first.values[3], 1337000);
+
+    struct param_snapshot second;
+    ASSERT_EQ(ParamSnapshot(&second), 0);
+    ASSERT_EQ(second.generation, first.generation);
+
+    ASSERT_EQ(ParamSetUint8param(150), 0);
+    ASSERT_EQ(ParamSnapshot(&second), 0);
+    ASSERT_NE(second.generation, first.generation);
+    ASSERT_EQ(second.values[2], 150);
+
+    ASSERT_EQ(ParamSnapshot(nullptr), -1);
+}
+
+TEST_F(ParametersTests, Restore_RollsBackChanges) {
+    struct param_snapshot snapshot;
+    ASSERT_EQ(ParamSnapshot(&snapshot), 0);
+    ParamLoadDefaults(kParamType2);
+    ASSERT_EQ(ParamSetUint8param(150), 0);
+    ASSERT_EQ(ParamFlush(), PARAM_NUM_PARAMS);
+
+    const unsigned int n_reschedules = k_work_reschedule_fake.call_count;
+    ASSERT_EQ(ParamRestore(&snapshot), 4);  // machine type, EnumParam, UInt8Param, Int32Param
+    ASSERT_EQ(k_work_reschedule_fake.call_count, n_reschedules + 1);
+    ASSERT_EQ(ParamGetMachineType(), kParamType1);
+    ASSERT_EQ(ParamGetEnumparam(), kParamValue1);
+    ASSERT_EQ(ParamGetUint8param(), 123);
+    ASSERT_EQ(ParamGetInt32param(), 1337000);
+    ASSERT_EQ(ParamFlush(), 4);
+
+    // Nothing to restore
+    ASSERT_EQ(ParamRestore(&snapshot), 0);
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+    ASSERT_EQ(ParamRestore(nullptr), -1);
+}
+
+TEST_F(ParametersTests, LoadDefaults_LeavesMutexUnlocked) {
+    RESET_FAKE(k_mutex_lock);
+    RESET_FAKE(k_mutex_unlock);
+    ParamLoadDefaults(kParamType2);
+    ParamLoadDefaults(42);  // unknown machine type
+    ASSERT_EQ(k_mutex_lock_fake.call_count, 2);
+    ASSERT_EQ(k_mutex_unlock_fake.call_count, 2);
+}
+
+TEST_F(ParametersTests, Flush_SavesOnlyChangedParameters) {
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+    ASSERT_EQ(ParamFlush(), 0);
+    ASSERT_EQ(settings_save_one_fake.call_count, 0);
+
+    const struct param_t* param;
+    GetUInt8Param(&param);
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    ASSERT_EQ(ParamIncreaseValue(param), 0);
+    ASSERT_EQ(ParamIncreaseValue(param), 0);
+    ASSERT_TRUE(ParamHasUnsavedChanges());
+
+    ASSERT_EQ(ParamFlush(), 2);
+    ASSERT_EQ(settings_save_one_fake.call_count, 2);
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+    ASSERT_EQ(ParamFlush(), 0);
+}
+
+TEST_F(ParametersTests, Flush_FailedSaveStaysChanged) {
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    settings_save_one_fake.return_val = -EIO;
+    ASSERT_EQ(ParamFlush(), -EIO);
+    ASSERT_TRUE(ParamHasUnsavedChanges());
+
+    settings_save_one_fake.return_val = 0;
+    ASSERT_EQ(ParamFlush(), 1);
+    ASSERT_STREQ(settings_save_one_fake.arg0_val, "parameters/Int32param");
+}
+
+static int param_mutex_depth_;
+
+static int lock_counting(struct k_mutex* mutex, k_timeout_t) {
+    if (mutex == &param_mutex) {
+        ++param_mutex_depth_;
+    }
+    return 0;
+}
+
+static void unlock_counting(struct k_mutex* mutex) {
+    if (mutex == &param_mutex) {
+        --param_mutex_depth_;
+    }
+}
+
+// A write during which the UI changes the value being saved
+static int save_while_changing(const char*, const void*, size_t) {
+    EXPECT_EQ(param_mutex_depth_, 0);
+    EXPECT_EQ(ParamSetInt32param(1600000), 0);
+    return 0;
+}
+
+TEST_F(ParametersTests, Flush_WritesWithoutParamMutex) {
+    param_mutex_depth_ = 0;
+    k_mutex_lock_fake.custom_fake = lock_counting;
+    k_mutex_unlock_fake.custom_fake = unlock_counting;
+    settings_save_one_fake.custom_fake = save_while_changing;
+
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    ASSERT_EQ(ParamFlush(), 1);
+    ASSERT_EQ(*static_cast<const int32_t*>(settings_save_one_fake.arg1_val), 1500000);
+    // Changed during the write, so still unsaved
+    ASSERT_TRUE(ParamHasUnsavedChanges());
+
+    const struct param_t* param;
+    GetInt32Param(&param);
+    ASSERT_EQ(ParamSave(param), 0);
+    ASSERT_TRUE(ParamHasUnsavedChanges());
+
+    settings_save_one_fake.custom_fake = NULL;
+    ASSERT_EQ(ParamFlush(), 1);
+    ASSERT_EQ(*static_cast<const int32_t*>(settings_save_one_fake.arg1_val), 1600000);
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+    ASSERT_EQ(param_mutex_depth_, 0);
+
+    k_mutex_lock_fake.custom_fake = NULL;
+    k_mutex_unlock_fake.custom_fake = NULL;
+}
+
+TEST_F(ParametersTests, Save_ClearsChanged) {
+    const struct param_t* param;
+    GetInt32Param(&param);
+    ASSERT_EQ(ParamSetValue(param, 1500000), 0);
+    ASSERT_EQ(ParamSave(param), 0);
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+}
+
+TEST_F(ParametersTests, LoadDefaults_MarksAllChanged) {
+    ParamLoadDefaults(kParamType2);
+    ASSERT_EQ(ParamFlush(), PARAM_NUM_PARAMS);
+}
+
+TEST_F(ParametersTests, WriteBehind_ChangeRestartsQuietPeriod) {
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 0);
+
+    const struct param_t* param;
+    GetUInt8Param(&param);
+    ASSERT_EQ(ParamIncreaseValue(param), 0);
+    ASSERT_EQ(ParamIncreaseValue(param), 0);
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 3);
+    ASSERT_EQ(k_work_reschedule_fake.arg1_val, 2000);
+    // The maximum delay is not extended by later changes (k_work_schedule() leaves scheduled work alone)
+    ASSERT_EQ(k_work_schedule_fake.arg1_history[0], 30000);
+
+    // Rejected values do not schedule a save
+    ASSERT_EQ(ParamSetInt32param(999999), -1);
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 3);
+}
+
+TEST_F(ParametersTests, WriteBehind_WorkFlushesChanges) {
+    ASSERT_EQ(k_work_init_delayable_fake.call_count, 3);
+    struct k_work_delayable* quiet_work = k_work_init_delayable_fake.arg0_history[0];
+    k_work_handler_t handler = k_work_init_delayable_fake.arg1_history[0];
+
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    handler(&quiet_work->work);
+    ASSERT_EQ(settings_save_one_fake.call_count, 1);
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+
+    // A failed save is retried after another quiet period
+    ASSERT_EQ(ParamSetInt32param(1600000), 0);
+    settings_save_one_fake.return_val = -EIO;
+    const unsigned int n_reschedules = k_work_reschedule_fake.call_count;
+    handler(&quiet_work->work);
+    ASSERT_TRUE(ParamHasUnsavedChanges());
+    ASSERT_EQ(k_work_reschedule_fake.call_count, n_reschedules + 1);
+}
+
+TEST_F(ParametersTests, WriteBehind_StartRequestFlushesNow) {
+    struct kzbus_msg_t msg = {};
+    msg.msg_type = kMsgReqStart;
+    zbus_chan_const_msg_fake.return_val = &msg;
+
+    // Nothing to save
+    param_write_behind_listener.callback(&kzbus_control_chan);
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 0);
+
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    msg.msg_type = kMsgReqStop;
+    param_write_behind_listener.callback(&kzbus_control_chan);
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 1);
+
+    msg.msg_type = kMsgReqStart;
+    param_write_behind_listener.callback(&kzbus_control_chan);
+    ASSERT_EQ(k_work_reschedule_fake.call_count, 2);
+    ASSERT_EQ(k_work_reschedule_fake.arg1_val, K_NO_WAIT);
+}
+
+TEST_F(ParametersTests, ChangesPublishedOnce) {
+    // Initialized after the write-behind work items
+    struct k_work_delayable* notify_work = k_work_init_delayable_fake.arg0_history[2];
+    k_work_handler_t notify = k_work_init_delayable_fake.arg1_history[2];
+    const unsigned int n_schedules = k_work_schedule_fake.call_count;
+
+    const struct param_t* param;
+    GetUInt8Param(&param);
+    ASSERT_EQ(ParamIncreaseValue(param), 0);
+    ASSERT_EQ(ParamIncreaseValue(param), 0);
+    ASSERT_EQ(ParamSetInt32param(1500000), 0);
+    ASSERT_EQ(ParamSetInt32param(1600000), 0);
+    ASSERT_EQ(zbus_chan_pub_fake.call_count, 0);
+
+    notify(&notify_work->work);
+    ASSERT_EQ(zbus_chan_pub_fake.call_count, 1);
+    ASSERT_EQ(zbus_chan_pub_fake.arg0_val, &kzbus_param_chan);
+    ASSERT_EQ(published_.msg_type, kMsgParamChanged);
+    ASSERT_EQ(published_.param_msg.n_changed, 2);
+    ASSERT_EQ(published_.param_msg.changed_ids[0], 1 << 2);   // Int32Param (Id 2)
+    ASSERT_EQ(published_.param_msg.changed_ids[1], 1 << 2);   // UInt8Param (Id 10)
+    ASSERT_FALSE(published_.param_msg.other_changed);
+
+    // Scheduled by the first change of each parameter in a batch, not by every change
+    int n_notify_schedules = 0;
+    for (unsigned int i = n_schedules; i < k_work_schedule_fake.call_count; ++i) {
+        n_notify_schedules += k_work_schedule_fake.arg0_history[i] == notify_work ? 1 : 0;
+    }
+    ASSERT_EQ(n_notify_schedules, 2);
+
+    // Nothing changed since
+    notify(&notify_work->work);
+    ASSERT_EQ(zbus_chan_pub_fake.call_count, 1);
+}
+
+TEST_F(ParametersTests, LoadedValuesPublished) {
+    settings_name_next_fake.custom_fake = name_next;
+    struct settings_handler* handler = settings_register_fake.arg0_val;
+    k_work_handler_t notify = k_work_init_delayable_fake.arg1_history[2];
+    int32_t value = 1500000;
+
+    ASSERT_EQ(handler->h_set("Int32param", sizeof(value), read_int32, &value), 0);
+    notify(NULL);
+    ASSERT_EQ(published_.param_msg.n_changed, 1);
+    ASSERT_EQ(published_.param_msg.changed_ids[0], 1 << 2);
+    // Not saved again
+    ASSERT_FALSE(ParamHasUnsavedChanges());
+    settings_name_next_fake.custom_fake = NULL;
+}
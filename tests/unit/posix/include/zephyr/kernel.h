@@ -0,0 +1,86 @@
+#pragma once
+
+// Host implementation of the parts of the Zephyr kernel API used by koster-common, on top of pthreads.
+// Unlike the fff fakes in tests/unit/include, these really lock, block and run work items, so code
+// built against them can be exercised from many threads.
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Timeouts are in milliseconds, K_FOREVER waits indefinitely
+typedef int64_t k_timeout_t;
+
+#define K_FOREVER ((k_timeout_t)-1)
+#define K_NO_WAIT ((k_timeout_t)0)
+#define K_MSEC(X) ((k_timeout_t)(X))
+#define K_SECONDS(X) ((k_timeout_t)(X) * 1000)
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define ARG_UNUSED(x) (void)(x)
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#define __packed __attribute__((__packed__))
+#define CONTAINER_OF(ptr, type, field) ((type *)(((char *)(ptr)) - offsetof(type, field)))
+
+// Recursive, like a Zephyr mutex
+struct k_mutex {
+    pthread_mutex_t mutex;
+};
+
+int k_mutex_init(struct k_mutex *mutex);
+int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout);
+int k_mutex_unlock(struct k_mutex *mutex);
+
+struct k_sem {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned int count;
+    unsigned int limit;
+};
+
+int k_sem_init(struct k_sem *sem, unsigned int initial_count, unsigned int limit);
+int k_sem_take(struct k_sem *sem, k_timeout_t timeout);
+void k_sem_give(struct k_sem *sem);
+unsigned int k_sem_count_get(struct k_sem *sem);
+
+int64_t k_uptime_get(void);
+uint32_t k_uptime_seconds(void);
+int32_t k_msleep(int32_t ms);
+
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+// Work items run on a single system work queue thread, started by the first submit
+struct k_work {
+    k_work_handler_t handler;
+    struct k_work *next;  // next item in the work queue, ordered by deadline
+    int64_t deadline;     // uptime (ms) when the item is due
+    bool queued;
+};
+
+struct k_work_delayable {
+    struct k_work work;
+};
+
+void k_work_init(struct k_work *work, k_work_handler_t handler);
+int k_work_submit(struct k_work *work);
+void k_work_init_delayable(struct k_work_delayable *dwork, k_work_handler_t handler);
+int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay);
+int k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay);
+int k_work_cancel_delayable(struct k_work_delayable *dwork);
+
+/**
+ * Wait until the work queue has no item due within max_delay_ms, and none is running.
+ */
+void k_work_queue_drain(int64_t max_delay_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+// Logging is compiled out, so that stress runs measure the code and not the console
+
+#define LOG_MODULE_REGISTER(X)
+#define LOG_MODULE_DECLARE(X)
+#define LOG_ERR(...) \
+    do {             \
+    } while (0)
+#define LOG_INF(...) \
+    do {             \
+    } while (0)
+#define LOG_WRN(...) \
+    do {             \
+    } while (0)
+#define LOG_DBG(...) \
+    do {             \
+    } while (0)
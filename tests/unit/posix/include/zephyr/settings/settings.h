@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef ssize_t (*settings_read_cb)(void *cb_arg, void *data, size_t len);
+
+struct settings_handler {
+    const char *name;
+    int (*h_get)(const char *key, char *val, int val_len_max);
+    int (*h_set)(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg);
+    int (*h_commit)(void);
+    int (*h_export)(int (*export_func)(const char *name, const void *val, size_t val_len));
+};
+
+// Settings are kept in RAM: settings_load() hands everything saved since start to the registered handlers
+int settings_subsys_init(void);
+int settings_register(struct settings_handler *handler);
+int settings_load(void);
+int settings_load_subtree(const char *subtree);
+int settings_save_one(const char *name, const void *value, size_t val_len);
+int settings_delete(const char *name);
+int settings_name_next(const char *name, const char **next);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "zephyr/kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct zbus_channel {
+    const char *name;
+};
+
+#define ZBUS_CHAN_DECLARE(...) extern const struct zbus_channel __VA_ARGS__
+
+// Provided by the test program, it may be called from several threads at once
+int zbus_chan_pub(const struct zbus_channel *chan, const void *msg, k_timeout_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,240 @@
+#include "zephyr/kernel.h"
+
+#include <time.h>
+
+static pthread_once_t uptime_once_ = PTHREAD_ONCE_INIT;
+static struct timespec boot_time_;
+
+static void init_uptime(void) { clock_gettime(CLOCK_MONOTONIC, &boot_time_); }
+
+int64_t k_uptime_get(void) {
+    struct timespec now;
+    pthread_once(&uptime_once_, init_uptime);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - boot_time_.tv_sec) * 1000 + (now.tv_nsec - boot_time_.tv_nsec) / 1000000;
+}
+
+uint32_t k_uptime_seconds(void) { return (uint32_t)(k_uptime_get() / 1000); }
+
+int32_t k_msleep(int32_t ms) {
+    struct timespec delay = {.tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000};
+    nanosleep(&delay, NULL);
+    return 0;
+}
+
+// Absolute CLOCK_REALTIME time for pthread timed waits
+static struct timespec deadline_after(const int64_t ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+    return deadline;
+}
+
+int k_mutex_init(struct k_mutex *mutex) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return 0;
+}
+
+int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout) {
+    if (timeout == K_FOREVER) {
+        return pthread_mutex_lock(&mutex->mutex) == 0 ? 0 : -EINVAL;
+    }
+    if (timeout == K_NO_WAIT) {
+        return pthread_mutex_trylock(&mutex->mutex) == 0 ? 0 : -EBUSY;
+    }
+
+    const struct timespec deadline = deadline_after(timeout);
+    return pthread_mutex_timedlock(&mutex->mutex, &deadline) == 0 ? 0 : -EAGAIN;
+}
+
+int k_mutex_unlock(struct k_mutex *mutex) { return pthread_mutex_unlock(&mutex->mutex) == 0 ? 0 : -EPERM; }
+
+int k_sem_init(struct k_sem *sem, unsigned int initial_count, unsigned int limit) {
+    if (limit == 0 || initial_count > limit) {
+        return -EINVAL;
+    }
+    pthread_mutex_init(&sem->mutex, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->count = initial_count;
+    sem->limit = limit;
+    return 0;
+}
+
+int k_sem_take(struct k_sem *sem, k_timeout_t timeout) {
+    int rc = 0;
+    const struct timespec deadline = deadline_after(timeout > 0 ? timeout : 0);
+
+    pthread_mutex_lock(&sem->mutex);
+    while (sem->count == 0 && rc == 0) {
+        if (timeout == K_NO_WAIT) {
+            rc = -EBUSY;
+        } else if (timeout == K_FOREVER) {
+            pthread_cond_wait(&sem->cond, &sem->mutex);
+        } else if (pthread_cond_timedwait(&sem->cond, &sem->mutex, &deadline) != 0) {
+            rc = -EAGAIN;
+        }
+    }
+    if (sem->count > 0) {
+        --sem->count;
+        rc = 0;
+    }
+    pthread_mutex_unlock(&sem->mutex);
+
+    return rc;
+}
+
+void k_sem_give(struct k_sem *sem) {
+    pthread_mutex_lock(&sem->mutex);
+    if (sem->count < sem->limit) {
+        ++sem->count;
+    }
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+unsigned int k_sem_count_get(struct k_sem *sem) {
+    pthread_mutex_lock(&sem->mutex);
+    const unsigned int count = sem->count;
+    pthread_mutex_unlock(&sem->mutex);
+    return count;
+}
+
+// The system work queue: a list of queued items ordered by deadline, and the thread that runs them
+static pthread_mutex_t work_mutex_ = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond_ = PTHREAD_COND_INITIALIZER;
+static struct k_work *work_queue_;
+static bool work_running_;
+static pthread_once_t work_thread_once_ = PTHREAD_ONCE_INIT;
+static pthread_t work_thread_;
+
+static void *work_thread(void *arg) {
+    ARG_UNUSED(arg);
+
+    pthread_mutex_lock(&work_mutex_);
+    for (;;) {
+        if (work_queue_ == NULL) {
+            pthread_cond_wait(&work_cond_, &work_mutex_);
+            continue;
+        }
+
+        const int64_t delay = work_queue_->deadline - k_uptime_get();
+        if (delay > 0) {
+            const struct timespec deadline = deadline_after(delay);
+            pthread_cond_timedwait(&work_cond_, &work_mutex_, &deadline);
+            continue;
+        }
+
+        struct k_work *work = work_queue_;
+        work_queue_ = work->next;
+        work->queued = false;
+        work_running_ = true;
+        pthread_mutex_unlock(&work_mutex_);
+
+        work->handler(work);
+
+        pthread_mutex_lock(&work_mutex_);
+        work_running_ = false;
+        pthread_cond_broadcast(&work_cond_);
+    }
+    return NULL;
+}
+
+static void start_work_thread(void) { pthread_create(&work_thread_, NULL, work_thread, NULL); }
+
+// Must be called with work_mutex_ held
+static void dequeue(struct k_work *work) {
+    for (struct k_work **link = &work_queue_; *link != NULL; link = &(*link)->next) {
+        if (*link == work) {
+            *link = work->next;
+            break;
+        }
+    }
+    work->queued = false;
+}
+
+// Must be called with work_mutex_ held
+static void enqueue(struct k_work *work, const k_timeout_t delay) {
+    work->deadline = k_uptime_get() + (delay > 0 ? delay : 0);
+
+    struct k_work **link = &work_queue_;
+    while (*link != NULL && (*link)->deadline <= work->deadline) {
+        link = &(*link)->next;
+    }
+    work->next = *link;
+    *link = work;
+    work->queued = true;
+    pthread_cond_broadcast(&work_cond_);
+}
+
+void k_work_init(struct k_work *work, k_work_handler_t handler) {
+    work->handler = handler;
+    work->next = NULL;
+    work->deadline = 0;
+    work->queued = false;
+}
+
+int k_work_submit(struct k_work *work) {
+    int rc = 0;
+    pthread_once(&work_thread_once_, start_work_thread);
+    pthread_mutex_lock(&work_mutex_);
+    if (!work->queued) {
+        enqueue(work, K_NO_WAIT);
+        rc = 1;
+    }
+    pthread_mutex_unlock(&work_mutex_);
+    return rc;
+}
+
+void k_work_init_delayable(struct k_work_delayable *dwork, k_work_handler_t handler) {
+    k_work_init(&dwork->work, handler);
+}
+
+int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    int rc = 0;
+    pthread_once(&work_thread_once_, start_work_thread);
+    pthread_mutex_lock(&work_mutex_);
+    if (!dwork->work.queued) {
+        enqueue(&dwork->work, delay);
+        rc = 1;
+    }
+    pthread_mutex_unlock(&work_mutex_);
+    return rc;
+}
+
+int k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    pthread_once(&work_thread_once_, start_work_thread);
+    pthread_mutex_lock(&work_mutex_);
+    if (dwork->work.queued) {
+        dequeue(&dwork->work);
+    }
+    enqueue(&dwork->work, delay);
+    pthread_mutex_unlock(&work_mutex_);
+    return 1;
+}
+
+int k_work_cancel_delayable(struct k_work_delayable *dwork) {
+    pthread_mutex_lock(&work_mutex_);
+    if (dwork->work.queued) {
+        dequeue(&dwork->work);
+    }
+    pthread_mutex_unlock(&work_mutex_);
+    return 0;
+}
+
+void k_work_queue_drain(int64_t max_delay_ms) {
+    pthread_mutex_lock(&work_mutex_);
+    while (work_running_ || (work_queue_ != NULL && work_queue_->deadline <= k_uptime_get() + max_delay_ms)) {
+        const struct timespec deadline = deadline_after(1);
+        pthread_cond_timedwait(&work_cond_, &work_mutex_, &deadline);
+    }
+    pthread_mutex_unlock(&work_mutex_);
+}
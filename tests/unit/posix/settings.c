@@ -0,0 +1,125 @@
+#include "zephyr/settings/settings.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_HANDLERS 8
+
+struct stored_setting {
+    char *name;
+    void *value;
+    size_t len;
+};
+
+struct read_arg {
+    const struct stored_setting *setting;
+};
+
+static pthread_mutex_t settings_mutex_ = PTHREAD_MUTEX_INITIALIZER;
+static struct settings_handler *handlers_[MAX_HANDLERS];
+static int n_handlers_;
+static struct stored_setting *store_;
+static size_t n_stored_;
+static size_t store_size_;
+
+int settings_subsys_init(void) { return 0; }
+
+int settings_register(struct settings_handler *handler) {
+    int rc = -ENOMEM;
+    pthread_mutex_lock(&settings_mutex_);
+    if (n_handlers_ < MAX_HANDLERS) {
+        handlers_[n_handlers_++] = handler;
+        rc = 0;
+    }
+    pthread_mutex_unlock(&settings_mutex_);
+    return rc;
+}
+
+static ssize_t read_stored(void *cb_arg, void *data, size_t len) {
+    const struct stored_setting *setting = ((struct read_arg *)cb_arg)->setting;
+    const size_t n = len < setting->len ? len : setting->len;
+    memcpy(data, setting->value, n);
+    return (ssize_t)n;
+}
+
+// Like the settings subsystem, offers every stored entry to the handler whose name is its first path component.
+// Only handlers named subtree, unless it is NULL.
+static int load(const char *subtree) {
+    pthread_mutex_lock(&settings_mutex_);
+    for (size_t i = 0; i < n_stored_; ++i) {
+        const char *name = store_[i].name;
+        const int name_len = settings_name_next(name, NULL);
+        for (int h = 0; h < n_handlers_; ++h) {
+            if (strlen(handlers_[h]->name) == (size_t)name_len && !strncmp(handlers_[h]->name, name, name_len) &&
+                name[name_len] == '/' && (subtree == NULL || !strcmp(handlers_[h]->name, subtree))) {
+                struct read_arg arg = {&store_[i]};
+                handlers_[h]->h_set(name + name_len + 1, store_[i].len, read_stored, &arg);
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&settings_mutex_);
+    return 0;
+}
+
+int settings_load(void) { return load(NULL); }
+
+int settings_load_subtree(const char *subtree) { return load(subtree); }
+
+int settings_save_one(const char *name, const void *value, size_t val_len) {
+    int rc = 0;
+    pthread_mutex_lock(&settings_mutex_);
+
+    size_t i = 0;
+    while (i < n_stored_ && strcmp(store_[i].name, name) != 0) {
+        ++i;
+    }
+    if (i == n_stored_) {
+        if (n_stored_ == store_size_) {
+            const size_t size = store_size_ != 0 ? store_size_ * 2 : 64;
+            struct stored_setting *store = realloc(store_, size * sizeof(*store_));
+            if (store == NULL) {
+                rc = -ENOMEM;
+                goto out;
+            }
+            store_ = store;
+            store_size_ = size;
+        }
+        store_[i].name = strdup(name);
+        store_[i].value = NULL;
+        ++n_stored_;
+    }
+
+    free(store_[i].value);
+    store_[i].value = malloc(val_len);
+    memcpy(store_[i].value, value, val_len);
+    store_[i].len = val_len;
+
+out:
+    pthread_mutex_unlock(&settings_mutex_);
+    return rc;
+}
+
+int settings_delete(const char *name) {
+    pthread_mutex_lock(&settings_mutex_);
+    for (size_t i = 0; i < n_stored_; ++i) {
+        if (strcmp(store_[i].name, name) == 0) {
+            free(store_[i].name);
+            free(store_[i].value);
+            store_[i] = store_[--n_stored_];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&settings_mutex_);
+    return 0;
+}
+
+int settings_name_next(const char *name, const char **next) {
+    const char *separator = strchr(name, '/');
+    if (next != NULL) {
+        *next = separator != NULL ? separator + 1 : NULL;
+    }
+    return separator != NULL ? (int)(separator - name) : (int)strlen(name);
+}
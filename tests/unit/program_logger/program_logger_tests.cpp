@@ -0,0 +1,231 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "fff/fff.h"
+#include "koster-common/program_logger.h"
+#include "zephyr/storage/flash_map.h"
+
+DEFINE_FFF_GLOBALS;
+}
+
+constexpr size_t kSectorSize{64};
+constexpr size_t kSectors{2};
+// With the 8 byte log entry header, four entries fit in the partition
+constexpr size_t kEntrySize{24};
+constexpr size_t kMaxEntries{4};
+
+// In-memory flash partition behind the flash_area_* fakes. Writes can only clear bits, as on NOR flash.
+struct flash_area flash_area_ = {.fa_id = 0, .fa_off = 0, .fa_size = kSectorSize * kSectors};
+std::vector<uint8_t> flash_;
+
+int flash_open(uint8_t, const struct flash_area** fap) {
+    *fap = &flash_area_;
+    return 0;
+}
+
+int flash_get_sectors(int, uint32_t* cnt, struct flash_sector* sectors) {
+    sectors[0] = {.fs_off = 0, .fs_size = kSectorSize};
+    *cnt = 1;
+    return -ENOMEM;  // more sectors than fit in the array
+}
+
+int flash_read(const struct flash_area*, off_t off, void* dst, size_t len) {
+    if (off < 0 || off + len > flash_.size()) {
+        return -EINVAL;
+    }
+    memcpy(dst, &flash_[off], len);
+    return 0;
+}
+
+int flash_write(const struct flash_area*, off_t off, const void* src, size_t len) {
+    if (off < 0 || off + len > flash_.size()) {
+        return -EINVAL;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        flash_[off + i] &= static_cast<const uint8_t*>(src)[i];
+    }
+    return 0;
+}
+
+int flash_erase(const struct flash_area*, off_t off, size_t len) {
+    if (off < 0 || off + len > flash_.size()) {
+        return -EINVAL;
+    }
+    memset(&flash_[off], 0xFF, len);
+    return 0;
+}
+
+// Write an entry straight to flash, as an earlier boot would have left it
+void preload(const size_t slot, const uint16_t sequence, const std::string& data) {
+    const size_t offset = slot * (kEntrySize + 8);
+    const uint32_t magic = 0xAFFECAFE;
+    const uint16_t length = data.size();
+    memcpy(&flash_[offset], &magic, sizeof(magic));
+    memcpy(&flash_[offset + 4], &sequence, sizeof(sequence));
+    memcpy(&flash_[offset + 6], &length, sizeof(length));
+    memcpy(&flash_[offset + 8], data.data(), data.size());
+}
+
+uint16_t sequence_at(const size_t slot) {
+    uint16_t sequence;
+    memcpy(&sequence, &flash_[slot * (kEntrySize + 8) + 4], sizeof(sequence));
+    return sequence;
+}
+
+std::vector<std::string> entries_;
+int read_callback(const program_log_entry_t* entry, void* arg) {
+    char data[kEntrySize];
+    const int n = ProgramLoggerRead(entry, data, sizeof(data));
+    EXPECT_GE(n, 0);
+    entries_.emplace_back(data, n);
+    return arg != NULL && entries_.size() == *static_cast<size_t*>(arg) ? 1 : 0;
+}
+
+std::vector<std::string> read_all() {
+    entries_.clear();
+    const int n = ProgramLoggerEmit(read_callback, NULL);
+    EXPECT_EQ(n, static_cast<int>(entries_.size()));
+    return entries_;
+}
+
+int write(const std::string& data) { return ProgramLoggerWrite(data.data(), data.size()); }
+
+class ProgramLoggerTests : public testing::Test {
+  protected:
+    void SetUp() override {
+        RESET_FAKE(flash_area_open);
+        RESET_FAKE(flash_area_get_sectors);
+        RESET_FAKE(flash_area_read);
+        RESET_FAKE(flash_area_write);
+        RESET_FAKE(flash_area_erase);
+        flash_area_open_fake.custom_fake = flash_open;
+        flash_area_get_sectors_fake.custom_fake = flash_get_sectors;
+        flash_area_read_fake.custom_fake = flash_read;
+        flash_area_write_fake.custom_fake = flash_write;
+        flash_area_erase_fake.custom_fake = flash_erase;
+        flash_.assign(flash_area_.fa_size, 0xFF);
+        ASSERT_EQ(ProgramLoggerInit(kEntrySize), 0);
+    };
+};
+
+TEST_F(ProgramLoggerTests, Empty_EmitsNothing) { ASSERT_EQ(read_all(), std::vector<std::string>{}); }
+
+TEST_F(ProgramLoggerTests, Write_ReadsBackOldestFirst) {
+    ASSERT_EQ(write("first"), 0);
+    ASSERT_EQ(write("second"), 0);
+    ASSERT_EQ(write("third"), 0);
+
+    ASSERT_EQ(read_all(), (std::vector<std::string>{"first", "second", "third"}));
+}
+
+TEST_F(ProgramLoggerTests, Write_EntryTooLong_ReturnsEinval) {
+    ASSERT_EQ(write(std::string(kEntrySize + 1, 'x')), -EINVAL);
+    ASSERT_EQ(write(std::string(kEntrySize, 'x')), 0);
+
+    ASSERT_EQ(read_all(), (std::vector<std::string>{std::string(kEntrySize, 'x')}));
+}
+
+TEST_F(ProgramLoggerTests, Write_EntriesDoNotOverlap) {
+    for (size_t i = 0; i < kMaxEntries; ++i) {
+        ASSERT_EQ(write(std::string(kEntrySize, 'a' + i)), 0);
+    }
+
+    ASSERT_EQ(read_all(),
+              (std::vector<std::string>{std::string(kEntrySize, 'a'),
+                                        std::string(kEntrySize, 'b'),
+                                        std::string(kEntrySize, 'c'),
+                                        std::string(kEntrySize, 'd')}));
+}
+
+TEST_F(ProgramLoggerTests, Write_LogFull_OverwritesOldestEntry) {
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_EQ(write(std::to_string(i)), 0);
+    }
+
+    ASSERT_EQ(read_all(), (std::vector<std::string>{"2", "3", "4", "5"}));
+}
+
+TEST_F(ProgramLoggerTests, Init_ContinuesAfterNewestEntry) {
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(write(std::to_string(i)), 0);
+    }
+
+    ASSERT_EQ(ProgramLoggerInit(kEntrySize), 0);
+    ASSERT_EQ(read_all(), (std::vector<std::string>{"1", "2", "3", "4"}));
+    ASSERT_EQ(write("5"), 0);
+    ASSERT_EQ(read_all(), (std::vector<std::string>{"2", "3", "4", "5"}));
+}
+
+TEST_F(ProgramLoggerTests, Init_SequenceWrapped_ContinuesAfterNewestEntry) {
+    preload(0, 0, "65536");
+    preload(1, 1, "65537");
+    preload(2, 65534, "65534");
+    preload(3, 65535, "65535");
+
+    ASSERT_EQ(ProgramLoggerInit(kEntrySize), 0);
+    ASSERT_EQ(read_all(), (std::vector<std::string>{"65534", "65535", "65536", "65537"}));
+
+    // The head is slot 2, holding the oldest entry
+    ASSERT_EQ(write("65538"), 0);
+    ASSERT_EQ(flash_area_erase_fake.arg1_val, 2 * (kEntrySize + 8));
+    ASSERT_EQ(sequence_at(2), 2);
+    ASSERT_EQ(read_all(), (std::vector<std::string>{"65535", "65536", "65537", "65538"}));
+}
+
+TEST_F(ProgramLoggerTests, Init_CorruptEntry_ContinuesAfterNewestEntry) {
+    preload(0, 65535, "65535");
+    preload(1, 0, "65536");
+    preload(2, 1, "65537");
+    preload(3, 65534, "65534");
+    flash_[3 * (kEntrySize + 8)] ^= 0xFF;
+
+    ASSERT_EQ(ProgramLoggerInit(kEntrySize), 0);
+    ASSERT_EQ(write("65538"), 0);
+    ASSERT_EQ(flash_area_erase_fake.arg1_val, 3 * (kEntrySize + 8));
+    ASSERT_EQ(read_all(), (std::vector<std::string>{"65535", "65536", "65537", "65538"}));
+}
+
+TEST_F(ProgramLoggerTests, Read_BufferSmallerThanEntry_ReadsBufferSize) {
+    ASSERT_EQ(write("0123456789"), 0);
+
+    char data[4];
+    entries_.clear();
+    ProgramLoggerEmit(
+            [](const program_log_entry_t* entry, void* arg) {
+                EXPECT_EQ(ProgramLoggerRead(entry, arg, 4), 4);
+                return 0;
+            },
+            data);
+    ASSERT_EQ(std::string(data, sizeof(data)), "0123");
+}
+
+TEST_F(ProgramLoggerTests, Emit_CallbackReturnsNonZero_Stops) {
+    ASSERT_EQ(write("first"), 0);
+    ASSERT_EQ(write("second"), 0);
+    ASSERT_EQ(write("third"), 0);
+
+    size_t stop_after = 2;
+    entries_.clear();
+    ASSERT_EQ(ProgramLoggerEmit(read_callback, &stop_after), 1);
+    ASSERT_EQ(entries_, (std::vector<std::string>{"first", "second"}));
+}
+
+TEST_F(ProgramLoggerTests, Emit_SkipsEntryWithCorruptMagic) {
+    ASSERT_EQ(write("first"), 0);
+    ASSERT_EQ(write("second"), 0);
+    flash_[0] ^= 0xFF;
+
+    ASSERT_EQ(read_all(), (std::vector<std::string>{"second"}));
+}
+
+TEST_F(ProgramLoggerTests, Init_EntryLargerThanSector_AlignsToSectors) {
+    ASSERT_EQ(ProgramLoggerInit(kSectorSize), 0);
+    std::string big(kSectorSize, 'x');
+    ASSERT_EQ(ProgramLoggerWrite(big.data(), big.size()), 0);
+
+    ASSERT_EQ(flash_area_erase_fake.arg2_val, kSectorSize * kSectors);
+}
@@ -0,0 +1,262 @@
+// Hammers the alarm module from many threads against the pthread kernel shim in tests/unit/posix.
+//
+// Usage: alarm_stress [iterations per writer] [writer threads] [reader threads]
+//
+// Writers toggle their own alarms with AlarmSet() while readers take snapshots, walk and query the active
+// set. The program prints throughput and latency percentiles per operation, and exits with 1 if any
+// invariant was violated.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "koster-common/alarm.h"
+#include "koster-common/alarm_stats.h"
+#include "koster-common/koster-zbus.h"
+#include "zephyr/kernel.h"
+
+extern const struct zbus_channel kzbus_alarm_chan;
+const struct zbus_channel kzbus_alarm_chan = {"kzbus_alarm_chan"};
+
+std::atomic<uint32_t> published_messages_{0};
+int zbus_chan_pub(const struct zbus_channel*, const void*, k_timeout_t) {
+    ++published_messages_;
+    return 0;
+}
+
+uint32_t RtcGetEpoch() { return 1700000000; }
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kAlarmsPerWriter{4};
+constexpr uint16_t kHoldOffMs{2};
+constexpr uint8_t kTypeAErrorId{0x02};
+const alarm_origin_t kWriterOrigins[] = {kAlarmOriginVinga1, kAlarmOriginVinga2, kAlarmOriginVinga3,
+                                         kAlarmOriginVinga4, kAlarmOriginVinga5};
+constexpr int kMaxWriters = sizeof(kWriterOrigins) / sizeof(kWriterOrigins[0]);
+
+std::atomic<bool> stop_readers_{false};
+std::atomic<int> violations_{0};
+
+void violation(const char* what) {
+    if (violations_++ < 10) {
+        std::fprintf(stderr, "violation: %s\n", what);
+    }
+}
+
+struct Latencies {
+    const char* name;
+    std::vector<uint32_t> ns;
+
+    void merge(const Latencies& other) { ns.insert(ns.end(), other.ns.begin(), other.ns.end()); }
+};
+
+template <typename F>
+void timed(Latencies& latencies, F&& op) {
+    const auto start = Clock::now();
+    op();
+    latencies.ns.push_back(
+        static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+}
+
+void report(Latencies& latencies, const double seconds) {
+    if (latencies.ns.empty()) {
+        return;
+    }
+    std::sort(latencies.ns.begin(), latencies.ns.end());
+    auto percentile = [&](const double p) {
+        return latencies.ns[std::min(latencies.ns.size() - 1, static_cast<size_t>(p * latencies.ns.size()))] /
+               1000.0;
+    };
+    std::printf("%-24s %9zu calls %12.0f /s   p50 %8.2f us   p99 %8.2f us   p99.9 %8.2f us   max %9.2f us\n",
+                latencies.name, latencies.ns.size(), latencies.ns.size() / seconds, percentile(0.5),
+                percentile(0.99), percentile(0.999), latencies.ns.back() / 1000.0);
+}
+
+struct Writer {
+    alarm_origin_t origin;
+    bool active[kAlarmsPerWriter] = {};
+    uint32_t raises[kAlarmsPerWriter] = {};
+    Latencies set{"AlarmSet", {}};
+};
+
+void run_writer(Writer& writer, const int iterations, const unsigned int seed) {
+    std::minstd_rand rng(seed);
+    writer.set.ns.reserve(iterations);
+
+    for (int i = 0; i < iterations; ++i) {
+        const int index = rng() % kAlarmsPerWriter;
+        writer.active[index] = !writer.active[index];
+        writer.raises[index] += writer.active[index] ? 1 : 0;
+
+        int rc = 0;
+        timed(writer.set, [&] { rc = AlarmSet(writer.active[index], index + 1, writer.origin); });
+        if (rc != 0) {
+            violation("AlarmSet failed");
+        }
+    }
+}
+
+// Raises, clears and acknowledges a type A alarm, so latching runs concurrently with the writers
+void run_type_a_writer(const int iterations, Latencies& acknowledge) {
+    for (int i = 0; i < iterations; ++i) {
+        AlarmSet(true, kTypeAErrorId, kAlarmOriginKoster);
+        AlarmSet(false, kTypeAErrorId, kAlarmOriginKoster);
+        timed(acknowledge, [] { AlarmAcknowledge(kTypeAErrorId | kAlarmOriginKoster); });
+    }
+}
+
+struct Reader {
+    Latencies snapshot{"AlarmSnapshot", {}};
+    Latencies walk{"AlarmWalk", {}};
+    Latencies type_a{"AlarmActiveTypeAAlarms", {}};
+    Latencies top{"AlarmGetTopActive", {}};
+};
+
+int count_callback(const struct alarm_t alarm, void* arg) {
+    if ((alarm.state & ALARM_STATE_CONDITION_ACTIVE) == 0) {
+        violation("AlarmWalk reported an alarm whose condition is not present");
+    }
+    ++*static_cast<int*>(arg);
+    return 0;
+}
+
+void check_snapshot(const struct alarm_snapshot& snapshot) {
+    if (snapshot.n_alarms > ALARM_MAX_ALARMS) {
+        violation("snapshot has too many alarms");
+        return;
+    }
+
+    std::set<uint16_t> ids;
+    for (int i = 0; i < snapshot.n_alarms; ++i) {
+        const struct alarm_t& alarm = snapshot.alarms[i];
+        if (alarm.id == 0 || !ids.insert(alarm.id).second) {
+            violation("snapshot has an empty or duplicate alarm");
+        }
+        if (alarm.state != kAlarmStateActive && alarm.state != kAlarmStateAcknowledged &&
+            alarm.state != kAlarmStateLatched) {
+            violation("snapshot has an alarm in an invalid state");
+        }
+    }
+
+    if (snapshot.n_alarms == 0 ? snapshot.top.id != 0 : ids.count(snapshot.top.id) == 0) {
+        violation("snapshot top alarm is not in the snapshot");
+    }
+}
+
+void run_reader(Reader& reader) {
+    while (!stop_readers_) {
+        struct alarm_snapshot snapshot;
+        timed(reader.snapshot, [&] { AlarmSnapshot(&snapshot); });
+        check_snapshot(snapshot);
+
+        int n_walked = 0;
+        timed(reader.walk, [&] { AlarmWalk(count_callback, &n_walked); });
+        if (n_walked > ALARM_MAX_ALARMS) {
+            violation("AlarmWalk reported too many alarms");
+        }
+
+        timed(reader.type_a, [] { AlarmActiveTypeAAlarms(); });
+
+        struct alarm_t top;
+        timed(reader.top, [&] { AlarmGetTopActive(&top); });
+    }
+}
+
+void check_final_state(const std::vector<Writer>& writers) {
+    for (size_t w = 0; w < writers.size(); ++w) {
+        for (int i = 0; i < kAlarmsPerWriter; ++i) {
+            if (AlarmIsActiveFrom(writers[w].origin, i + 1) != writers[w].active[i]) {
+                violation("final alarm state differs from the last AlarmSet()");
+            }
+
+            struct alarm_stats_t stats = {};
+            AlarmStatsGet((i + 1) | writers[w].origin, &stats);
+            // Raises within the hold-off of the first writer's alarms are not counted
+            if (w == 0 ? stats.count > writers[w].raises[i] : stats.count != writers[w].raises[i]) {
+                violation("alarm statistics count differs from the number of raises");
+            }
+        }
+    }
+
+    if (AlarmActiveTypeAAlarms()) {
+        violation("acknowledged type A alarm is still active");
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const int n_writers = std::clamp(argc > 2 ? std::atoi(argv[2]) : 4, 1, kMaxWriters);
+    const int n_readers = std::max(argc > 3 ? std::atoi(argv[3]) : 4, 0);
+
+    AlarmInit();
+    for (int i = 0; i < kAlarmsPerWriter; ++i) {
+        AlarmSetHoldOff((i + 1) | kWriterOrigins[0], kHoldOffMs);
+    }
+
+    std::vector<Writer> writers(n_writers);
+    std::vector<Reader> readers(n_readers);
+    Latencies acknowledge{"AlarmAcknowledge", {}};
+
+    const auto start = Clock::now();
+    std::vector<std::thread> reader_threads;
+    for (auto& reader : readers) {
+        reader_threads.emplace_back(run_reader, std::ref(reader));
+    }
+    std::vector<std::thread> writer_threads;
+    for (int w = 0; w < n_writers; ++w) {
+        writers[w].origin = kWriterOrigins[w];
+        writer_threads.emplace_back(run_writer, std::ref(writers[w]), iterations, 1234u + w);
+    }
+    writer_threads.emplace_back(run_type_a_writer, iterations / 4, std::ref(acknowledge));
+
+    for (auto& thread : writer_threads) {
+        thread.join();
+    }
+    stop_readers_ = true;
+    for (auto& thread : reader_threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Let held-off clears take effect
+    k_work_queue_drain(kHoldOffMs + 10);
+    check_final_state(writers);
+
+    std::printf("%d writers x %d iterations, %d readers, %.3f s, %u messages published\n", n_writers, iterations,
+                n_readers, seconds, published_messages_.load());
+    Latencies set{"AlarmSet", {}};
+    for (const auto& writer : writers) {
+        set.merge(writer.set);
+    }
+    Latencies snapshot{"AlarmSnapshot", {}}, walk{"AlarmWalk", {}}, type_a{"AlarmActiveTypeAAlarms", {}},
+        top{"AlarmGetTopActive", {}};
+    for (const auto& reader : readers) {
+        snapshot.merge(reader.snapshot);
+        walk.merge(reader.walk);
+        type_a.merge(reader.type_a);
+        top.merge(reader.top);
+    }
+    for (Latencies* latencies : {&set, &acknowledge, &snapshot, &walk, &type_a, &top}) {
+        report(*latencies, seconds);
+    }
+
+    if (violations_ > 0) {
+        std::printf("FAILED: %d violations\n", violations_.load());
+        return 1;
+    }
+    std::printf("PASSED\n");
+    return 0;
+}
@@ -0,0 +1,47 @@
+"""
+Writes a parameters configuration with a given number of parameters, for the parameter load benchmark
+"""
+import argparse
+from pathlib import Path
+
+N_CATEGORIES = 10
+
+header = """<?xml version="1.0" encoding="UTF-8"?>
+<Parameters>
+  <AccessLevels>
+    <AccessLevel Id="0" Name="Basic"/>
+  </AccessLevels>
+
+  <Categories>
+{categories}
+  </Categories>
+
+  <Enums>
+    <Enum Name="machine_type_t">
+      <EnumValue Name="TypeA" Value="0" />
+    </Enum>
+  </Enums>
+
+  <Units>
+    <Unit Id="0" Name="Unit" />
+  </Units>
+
+  <Parameter Id="0" Category="Category 0" Name="Machine type" Type="machine_type_t" AccessLevel="Basic" Description="" Default="TypeA" />
+{parameters}
+</Parameters>
+"""
+category = '    <Category Id="{id}" Name="Category {id}" />'
+parameter = '  <Parameter Id="{id}" Category="Category {category}" Name="Setting {id:04}" Type="int32_t" Min="-1000000" Max="1000000" Exponent="-3" Unit="Unit" AccessLevel="Basic" Description="" Default="{id}" />'
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--n-params', help="Number of parameters", type=int, required=True)
+    parser.add_argument('--output', help="Path to output configuration", type=Path, required=True)
+    args = parser.parse_args()
+
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    with open(args.output, 'w') as file_:
+        file_.write(header.format(
+            categories="\n".join(category.format(id=i) for i in range(N_CATEGORIES)),
+            parameters="\n".join(parameter.format(id=i, category=i % N_CATEGORIES) for i in range(1, args.n_params)),
+        ))
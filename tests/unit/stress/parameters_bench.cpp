@@ -0,0 +1,141 @@
+// Benchmark of a GUI-style parameter page render against the pthread kernel shim in tests/unit/posix.
+//
+// Usage: parameters_bench [renders] [writer threads]
+//
+// One render walks every category at the highest access level and reads name, value string, limits and
+// type of every parameter, as the settings screen does, once with the per-field getters and once with
+// ParamRowWalk(). Writer threads change parameter values meanwhile, as the control loop does.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "koster-common/koster-zbus.h"
+#include "koster-common/parameters.h"
+
+extern const struct zbus_channel kzbus_param_chan;
+const struct zbus_channel kzbus_param_chan = {"kzbus_param_chan"};
+int zbus_chan_pub(const struct zbus_channel*, const void*, k_timeout_t) { return 0; }
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::atomic<bool> stop_writers_{false};
+
+struct RenderContext {
+    char buf[PARAM_DESC_MAX_LEN + PARAM_NAME_MAX_LEN + PARAM_VALUE_STRING_MAX_LEN];
+    unsigned int checksum;
+};
+
+int render_param(const struct param_t* param, void* arg) {
+    RenderContext* ctx = static_cast<RenderContext*>(arg);
+    ParamGetName(param, ctx->buf);
+    ctx->checksum += ctx->buf[0];
+    ParamGetCurrentValueString(param, ctx->buf);
+    ctx->checksum += ctx->buf[0];
+    ctx->checksum += ParamGetId(param) + ParamGetMinValue(param) + ParamGetMaxValue(param) + ParamGetExponent(param);
+    ctx->checksum += ParamIsEnum(param) ? 1 : 0;
+    return 0;
+}
+
+int render_category(const struct param_category_t* category, void* arg) {
+    RenderContext* ctx = static_cast<RenderContext*>(arg);
+    ParamGetCategoryName(category, ctx->buf);
+    ctx->checksum += ctx->buf[0];
+    return ParamWalk(render_param, category, PARAM_ACCESS_LEVELS - 1, arg);
+}
+
+int render_row(const struct param_row* row, void* arg) {
+    RenderContext* ctx = static_cast<RenderContext*>(arg);
+    ctx->checksum += row->name[0];
+    ctx->checksum += row->value_string[0];
+    ctx->checksum += ParamGetId(row->param) + row->min + row->max + row->exponent;
+    ctx->checksum += row->is_enum ? 1 : 0;
+    return 0;
+}
+
+int render_category_rows(const struct param_category_t* category, void* arg) {
+    RenderContext* ctx = static_cast<RenderContext*>(arg);
+    ParamGetCategoryName(category, ctx->buf);
+    ctx->checksum += ctx->buf[0];
+    return ParamRowWalk(render_row, category, PARAM_ACCESS_LEVELS - 1, arg);
+}
+
+struct Result {
+    double seconds;
+    std::vector<uint32_t> ns;
+};
+
+Result run_renders(const int renders, param_category_walk_cb_t render, RenderContext& ctx) {
+    Result result;
+    result.ns.reserve(renders);
+    const auto start = Clock::now();
+    for (int i = 0; i < renders; ++i) {
+        const auto render_start = Clock::now();
+        ParamCategoryWalk(render, PARAM_ACCESS_LEVELS - 1, &ctx);
+        result.ns.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - render_start).count()));
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::sort(result.ns.begin(), result.ns.end());
+    return result;
+}
+
+void report(const char* name, const int renders, const Result& result) {
+    auto percentile = [&](const double p) {
+        return result.ns[std::min(result.ns.size() - 1, static_cast<size_t>(p * result.ns.size()))] / 1000.0;
+    };
+    std::printf("%-7s %.0f /s   p50 %.2f us   p99 %.2f us   p99.9 %.2f us   max %.2f us\n", name,
+                renders / result.seconds, percentile(0.5), percentile(0.99), percentile(0.999),
+                result.ns.back() / 1000.0);
+}
+
+void run_writer(const unsigned int index) {
+    const struct param_category_t* category;
+    const struct param_t* param;
+    unsigned int i = 0;
+
+    while (!stop_writers_) {
+        if (ParamGetCategory(&category, (index + i) % PARAM_NUM_CATEGORIES) == 0 &&
+            ParamCategoryGetParam(category, &param, 0) == 0) {
+            ParamSetValue(param, ParamGetValue(param));
+        }
+        ++i;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int renders = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const int n_writers = std::max(argc > 2 ? std::atoi(argv[2]) : 1, 0);
+
+    ParamInit();
+
+    std::vector<std::thread> writers;
+    for (int i = 0; i < n_writers; ++i) {
+        writers.emplace_back(run_writer, i);
+    }
+
+    RenderContext ctx{};
+    const Result fields = run_renders(renders, render_category, ctx);
+    const Result rows = run_renders(renders, render_category_rows, ctx);
+
+    stop_writers_ = true;
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    std::printf("%d renders of %d parameters in %d categories, %d writer threads (checksum %u)\n", renders,
+                PARAM_NUM_PARAMS, PARAM_NUM_CATEGORIES, n_writers, ctx.checksum);
+    report("fields:", renders, fields);
+    report("rows:", renders, rows);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Benchmark of formatting parameter values, as the GUI does for every visible row.
+//
+// Usage: parameters_format_bench [rounds]
+//
+// Each round formats up to 100 values spread over the range of every parameter with ParamGetValueString().
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" {
+#include "koster-common/koster-zbus.h"
+#include "koster-common/parameters.h"
+
+extern const struct zbus_channel kzbus_param_chan;
+const struct zbus_channel kzbus_param_chan = {"kzbus_param_chan"};
+int zbus_chan_pub(const struct zbus_channel*, const void*, k_timeout_t) { return 0; }
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int32_t kValuesPerParam{100};
+
+struct FormatContext {
+    char buf[PARAM_VALUE_STRING_MAX_LEN];
+    unsigned int checksum;
+    unsigned int n_formatted;
+};
+
+int format_param(const struct param_t* param, void* arg) {
+    FormatContext* ctx = static_cast<FormatContext*>(arg);
+    const int32_t min = ParamGetMinValue(param);
+    const int32_t step = std::max<int32_t>((ParamGetMaxValue(param) - min) / kValuesPerParam, 1);
+
+    for (int32_t i = 0; i < kValuesPerParam && min + i * step <= ParamGetMaxValue(param); ++i) {
+        if (ParamGetValueString(param, ctx->buf, min + i * step) == 0) {
+            ctx->checksum += ctx->buf[0];
+        }
+        ++ctx->n_formatted;
+    }
+    return 0;
+}
+
+int format_category(const struct param_category_t* category, void* arg) {
+    return ParamWalk(format_param, category, PARAM_ACCESS_LEVELS - 1, arg);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int rounds = std::max(argc > 1 ? std::atoi(argv[1]) : 2000, 1);
+
+    ParamInit();
+
+    FormatContext ctx{};
+    const auto start = Clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        ParamCategoryWalk(format_category, PARAM_ACCESS_LEVELS - 1, &ctx);
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("%u values of %d parameters formatted in %.3f s (checksum %u)\n", ctx.n_formatted, PARAM_NUM_PARAMS,
+                seconds, ctx.checksum);
+    std::printf("format: %.1f ns per value\n", seconds * 1e9 / ctx.n_formatted);
+    return 0;
+}
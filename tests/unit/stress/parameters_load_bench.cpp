@@ -0,0 +1,88 @@
+// Benchmark of loading all parameters from settings at boot, against the RAM settings store in tests/unit/posix.
+//
+// Usage: parameters_load_bench [loads]
+//
+// All parameters are saved once, then settings_load() is repeated, which hands every stored key to the
+// parameters settings handler. Built for generated catalogues of several sizes to show how the name lookup
+// in the handler scales.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "koster-common/koster-zbus.h"
+#include "koster-common/parameters.h"
+#include "zephyr/settings/settings.h"
+
+extern const struct zbus_channel kzbus_param_chan;
+const struct zbus_channel kzbus_param_chan = {"kzbus_param_chan"};
+int zbus_chan_pub(const struct zbus_channel*, const void*, k_timeout_t) { return 0; }
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int sum_param(const struct param_t* param, void* arg) {
+    *static_cast<int64_t*>(arg) += ParamGetValue(param);
+    return 0;
+}
+
+int clear_param(const struct param_t* param, void*) {
+    ParamSetValue(param, ParamGetMinValue(param));
+    return 0;
+}
+
+void walk_all(param_walk_cb_t cb, void* arg) {
+    const struct param_category_t* category;
+    for (unsigned int i = 0; ParamGetCategory(&category, i) == 0; ++i) {
+        ParamWalk(cb, category, PARAM_ACCESS_LEVELS - 1, arg);
+    }
+}
+
+int64_t sum_values() {
+    int64_t sum = 0;
+    walk_all(sum_param, &sum);
+    return sum;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int loads = std::max(argc > 1 ? std::atoi(argv[1]) : 1000, 1);
+
+    ParamInit();
+    ParamLoadDefaults(0);
+    const int64_t stored_sum = sum_values();
+    if (ParamFlush() != PARAM_NUM_PARAMS) {
+        std::printf("FAILED: not all parameters were saved\n");
+        return 1;
+    }
+    walk_all(clear_param, nullptr);
+
+    std::vector<uint32_t> ns;
+    ns.reserve(loads);
+    const auto start = Clock::now();
+    for (int i = 0; i < loads; ++i) {
+        const auto load_start = Clock::now();
+        settings_load();
+        ns.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - load_start).count()));
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(ns.begin(), ns.end());
+    std::printf("%d loads of %d parameters\n", loads, PARAM_NUM_PARAMS);
+    std::printf("load: p50 %.2f us   max %.2f us   %.1f ns per parameter\n", ns[ns.size() / 2] / 1000.0,
+                ns.back() / 1000.0, seconds * 1e9 / loads / PARAM_NUM_PARAMS);
+
+    if (sum_values() != stored_sum) {
+        std::printf("FAILED: loaded values differ from the saved values\n");
+        return 1;
+    }
+    std::printf("PASSED\n");
+    return 0;
+}